@@ -17,10 +17,12 @@ dashes = ['-',  # solid line
 	'-.',  # dash-dot line
 	':',  # dotted line
 	'-',
-	'--']
+	'--',
+	'-.',
+	':']
 
-markers = ['+', 'x', 's', '^', 'o', 'd']
-colors = ['r', 'b', 'y', 'g', 'm', 'c']
+markers = ['+', 'x', 's', '^', 'o', 'd', 'v', '*']
+colors = ['r', 'b', 'y', 'g', 'm', 'c', 'k', 'orange']
 
 
 class CmdLineParser(object):
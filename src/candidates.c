@@ -0,0 +1,119 @@
+//
+// Created by enrico on 25/06/21.
+//
+
+#include <float.h>
+#include "candidates.h"
+#include "distances.h"
+#include "kdtree.h"
+
+// k nearest neighbours of node i by scanning all the nodes, sorted by increasing cost
+static void scan_nearest(instance *inst, int i, int k, int *list, double *dist){
+    int len = 0;
+    for(int j = 0; j < inst->nnodes; j++){
+        if(i == j) continue;
+        double c = cost(i, j, inst);
+        if(len == k && c >= dist[k - 1]) continue;
+
+        // insertion sort on the (short) list
+        int p = (len < k) ? len++ : k - 1;
+        while(p > 0 && dist[p - 1] > c){
+            dist[p] = dist[p - 1];
+            list[p] = list[p - 1];
+            p--;
+        }
+        dist[p] = c;
+        list[p] = j;
+    }
+}
+
+/**
+ * Candidate lists: the NCANDIDATES nearest neighbours of every node, sorted by increasing cost.
+ * They are computed on first use (with a k-d tree, in O(n log n) for euclidean-like distances)
+ * and then cached in the instance.
+ *
+ * @param inst instance pointer
+ * @return inst->cand, where cand[i * inst->ncand + k] is the (k+1)-th nearest node to i
+ */
+const int * candidates(instance *inst){
+    if(inst->cand != NULL) return inst->cand;
+
+    int k = (inst->nnodes - 1 < NCANDIDATES) ? inst->nnodes - 1 : NCANDIDATES;
+    int *cand = malloc(inst->nnodes * k * sizeof(int));
+
+    if(inst->dist != GEO){
+        kdtree *tree = new_kdtree(inst->xcoord, inst->ycoord, inst->nnodes);
+        int nearest[KD_MAXK];
+        for(int p = 0; p < inst->nnodes; p++){
+            // query in tree order: consecutive queries visit the same subtrees
+            int i = tree->idx[p];
+
+            // i itself is the first one (unless there are duplicated points)
+            int len = kdtree_knn(tree, inst->xcoord[i], inst->ycoord[i], k + 1, nearest);
+            int *list = cand + i * k;
+            int l = 0;
+            for(int p = 0; p < len && l < k; p++)
+                if(nearest[p] != i) list[l++] = nearest[p];
+        }
+        free_kdtree(tree);
+    }else{
+        double *dist = malloc(k * sizeof(double));
+        for(int i = 0; i < inst->nnodes; i++)
+            scan_nearest(inst, i, k, cand + i * k, dist);
+        free(dist);
+    }
+
+    print(inst, 'D', 2, "Computed %d candidates for each node", k);
+    inst->ncand = k;
+    inst->cand = cand;
+    return cand;
+}
+
+typedef struct{
+    double cost;
+    int i, j;
+} wedge;
+
+static int compare_wedges(const void *a, const void *b){
+    double ca = ((const wedge *) a)->cost, cb = ((const wedge *) b)->cost;
+    return (ca > cb) - (ca < cb);
+}
+
+/**
+ * Edges of the candidate graph (without duplicates), sorted by increasing cost
+ * @param inst instance pointer
+ * @param nedges returned number of edges
+ * @return edge list, edges[2k] and edges[2k+1] are the endpoints of the k-th edge
+ */
+int * candidate_edges(instance *inst, int *nedges){
+    const int *cand = candidates(inst);
+    int n = inst->nnodes, k = inst->ncand;
+
+    wedge *w = malloc(n * k * sizeof(wedge));
+    int m = 0;
+    for(int i = 0; i < n; i++){
+        for(int h = 0; h < k; h++){
+            int j = cand[i * k + h];
+            if(j < i){ // skip it if it's in the list of j too
+                bool dup = false;
+                for(int l = 0; l < k && !dup; l++) dup = (cand[j * k + l] == i);
+                if(dup) continue;
+            }
+            w[m].cost = cost(i, j, inst);
+            w[m].i = i;
+            w[m].j = j;
+            m++;
+        }
+    }
+    qsort(w, m, sizeof(wedge), compare_wedges);
+
+    int *edges = malloc(2 * m * sizeof(int));
+    for(int e = 0; e < m; e++){
+        edges[2 * e] = w[e].i;
+        edges[2 * e + 1] = w[e].j;
+    }
+    free(w);
+
+    *nedges = m;
+    return edges;
+}
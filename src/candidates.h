@@ -0,0 +1,16 @@
+//
+// Created by enrico on 25/06/21.
+//
+
+#ifndef TSP_OP2_CANDIDATES_H
+#define TSP_OP2_CANDIDATES_H
+
+#include "utils.h"
+
+#define NCANDIDATES 10  // default candidate list length
+
+const int * candidates(instance *inst);
+
+int * candidate_edges(instance *inst, int *nedges);
+
+#endif //TSP_OP2_CANDIDATES_H
@@ -0,0 +1,100 @@
+//
+// Created by enrico on 12/07/21.
+//
+
+#include <stdlib.h>
+#include "edgeset.h"
+
+static long long edge_key(const edgeset *es, int i, int j){
+    return (i < j) ? (long long) i * es->nnodes + j : (long long) j * es->nnodes + i;
+}
+
+static int slot(const edgeset *es, long long key){
+    // multiplicative hashing
+    unsigned long long h = (unsigned long long) key * 0x9E3779B97F4A7C15ULL;
+    int s = (int) (h >> 32) & (es->hcap - 1);
+    while(es->hkey[s] != -1 && es->hkey[s] != key)
+        s = (s + 1) & (es->hcap - 1);
+    return s;
+}
+
+static void rehash(edgeset *es, int hcap){
+    free(es->hkey);
+    free(es->hval);
+    es->hcap = hcap;
+    es->hkey = malloc(hcap * sizeof(long long));
+    es->hval = malloc(hcap * sizeof(int));
+    for(int s = 0; s < hcap; s++) es->hkey[s] = -1;
+    for(int k = 0; k < es->n; k++){
+        long long key = edge_key(es, es->u[k], es->v[k]);
+        int s = slot(es, key);
+        es->hkey[s] = key;
+        es->hval[s] = k;
+    }
+}
+
+/**
+ * Create an empty edge set.
+ *
+ * @param nnodes number of nodes of the graph
+ * @param cap initial capacity (it grows on demand)
+ * @return the edge set
+ */
+edgeset * new_edgeset(int nnodes, int cap){
+    edgeset *es = malloc(sizeof(edgeset));
+    es->nnodes = nnodes;
+    es->n = 0;
+    es->cap = (cap > 16) ? cap : 16;
+    es->u = malloc(es->cap * sizeof(int));
+    es->v = malloc(es->cap * sizeof(int));
+    es->hkey = NULL;
+    es->hval = NULL;
+    int hcap = 32;
+    while(hcap < 2 * es->cap) hcap *= 2;
+    rehash(es, hcap);
+    return es;
+}
+
+void free_edgeset(edgeset *es){
+    if(es == NULL) return;
+    free(es->u);
+    free(es->v);
+    free(es->hkey);
+    free(es->hval);
+    free(es);
+}
+
+/**
+ * @return index of the edge [i, j], -1 if missing
+ */
+int edgeset_find(const edgeset *es, int i, int j){
+    int s = slot(es, edge_key(es, i, j));
+    return (es->hkey[s] == -1) ? -1 : es->hval[s];
+}
+
+/**
+ * Add the edge [i, j] if missing.
+ *
+ * @return index of the edge
+ */
+int edgeset_add(edgeset *es, int i, int j){
+    long long key = edge_key(es, i, j);
+    int s = slot(es, key);
+    if(es->hkey[s] != -1) return es->hval[s];
+
+    if(es->n == es->cap){
+        es->cap *= 2;
+        es->u = realloc(es->u, es->cap * sizeof(int));
+        es->v = realloc(es->v, es->cap * sizeof(int));
+    }
+    es->u[es->n] = (i < j) ? i : j;
+    es->v[es->n] = (i < j) ? j : i;
+    if(2 * (es->n + 1) > es->hcap){
+        es->n++;
+        rehash(es, 2 * es->hcap);
+        return es->n - 1;
+    }
+    es->hkey[s] = key;
+    es->hval[s] = es->n;
+    return es->n++;
+}
@@ -0,0 +1,29 @@
+//
+// Created by enrico on 12/07/21.
+//
+
+#ifndef TSP_OP2_EDGESET_H
+#define TSP_OP2_EDGESET_H
+
+#include <stdbool.h>
+
+// set of undirected edges [u, v] (u < v) indexed in insertion order,
+// i.e. the column -> edge map of a sparse model, plus an edge -> column hash
+typedef struct edgeset{
+    int nnodes;
+    int n, cap;         // number of edges and capacity
+    int *u, *v;         // endpoints of the k-th edge
+    int hcap;           // hash capacity (power of 2)
+    long long *hkey;    // edge key u * nnodes + v, -1 marks an empty slot
+    int *hval;          // edge index
+} edgeset;
+
+edgeset * new_edgeset(int nnodes, int cap);
+
+void free_edgeset(edgeset *es);
+
+int edgeset_find(const edgeset *es, int i, int j);
+
+int edgeset_add(edgeset *es, int i, int j);
+
+#endif //TSP_OP2_EDGESET_H
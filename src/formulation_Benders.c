@@ -3,108 +3,160 @@
 //
 
 #include <unistd.h>
+#include <sys/time.h>
 #include "formulation_Benders.h"
+#include "heuristics.h"
 #include "plot.h"
 
 /**
  * Update constraints.
- * Use subtours elimination on connected components.
+ * Use subtours elimination on connected components: all the SECs of an iteration are added
+ * in a single batch and kept in the master for the next iterations.
  *
  * @param inst general instance
- * @param env CPLEX environment
- * @param lp CPLEX linear problem
  * @param ncomp number of connected components
  * @param comp array specifying components
- * @return a new problem with updated constraints
+ * @param it iteration number (used in constraint names)
  */
 void updconstr(instance *inst, int ncomp, const int *comp, int it){
     if(ncomp <= 1) printerr(inst, "Illegal state: must be ncomp > 1");
-
-/*
-    // clone problem
-    int status;
-    CPXLPptr lp_clone = CPXcloneprob(inst->CPXenv, inst->CPXlp, &status);
-    if(status) printerr(inst, "Can't clone problem!");
-    // free old problem
-    if(CPXfreeprob(inst->CPXenv, &inst->CPXlp)) printerr(inst, "Can't free problem!");
-
-    inst->CPXlp = lp_clone;
-*/
-    int tot_cols = CPXgetnumcols(inst->CPXenv, inst->CPXlp);
-    char *rname[] = {(char *) malloc(BUFLEN)};
-    double *value = (double *) malloc(tot_cols * sizeof(double));
-    int *index = (int *) malloc(tot_cols * sizeof(int));
-    // initialize value vector that doesn't change!
-    for(int i = 0; i < tot_cols; i++) value[i] = 1;
-    char sense = 'L';
-    int izero = 0;
-
-    for(int curr_comp = 1; curr_comp <= ncomp; curr_comp++){
-        int csize = 0; // component size
-        int nedges = 0; // all possible edges in the component
-
-        for(int i = 0; i < inst->nnodes; i++){
-            if(comp[i] != curr_comp) continue;
-            csize++;
-            for(int j = i + 1; j < inst->nnodes; j++){
-                if(comp[j] != curr_comp) continue;
-
-                // here `i` and `j` must belong to `curr_comp`
-                if(nedges >= tot_cols) printerr(inst, "Illegal state: must be tot_edges < tot_cols!");
-                // save index
-                index[nedges++] = xpos_undirected(i, j, inst);
-            }
-        }
-        double rhs = csize - 1;
-        int nnz = nedges;
-        snprintf(rname[0], BUFLEN, "SEC(%d,%d,%d)", it, curr_comp, csize);
-        if(CPXaddrows(inst->CPXenv, inst->CPXlp, 0, 1, nnz, &rhs, &sense, &izero, index, value, NULL, rname))
-            printerr(inst, "Can't add rows!");
-        if(inst->verbose >= 3)
-            printf("Added constraints for component %d of size %d\n", curr_comp, csize);
+    int n = inst->nnodes;
+
+    // group nodes by component (labels start from 1)
+    int *start = (int *) calloc(ncomp + 2, sizeof(int));
+    int *nodes = (int *) malloc(n * sizeof(int));
+    for(int i = 0; i < n; i++) start[comp[i] + 1]++;
+    for(int c = 1; c <= ncomp; c++) start[c + 1] += start[c];
+    int *fill = (int *) malloc((ncomp + 1) * sizeof(int));
+    memcpy(fill, start, (ncomp + 1) * sizeof(int));
+    for(int i = 0; i < n; i++) nodes[fill[comp[i]]++] = i;
+    free(fill);
+
+    // x(E(S)) <= |S| - 1 for each component S
+    long long nnz = 0;
+    int maxnnz = 0;
+    for(int c = 1; c <= ncomp; c++){
+        int csize = start[c + 1] - start[c];
+        nnz += (long long) csize * (csize - 1) / 2;
+        if(csize * (csize - 1) / 2 > maxnnz) maxnnz = csize * (csize - 1) / 2;
     }
-    free(rname[0]);
+    rowbatch *b = new_rowbatch(inst, ncomp, (int) nnz);
+    int *index = (int *) malloc((maxnnz > 0 ? maxnnz : 1) * sizeof(int));
+    double *value = (double *) malloc((maxnnz > 0 ? maxnnz : 1) * sizeof(double));
+    for(int k = 0; k < maxnnz; k++) value[k] = 1;
+
+    for(int c = 1; c <= ncomp; c++){
+        int csize = start[c + 1] - start[c];
+        int *s = nodes + start[c];
+        int nedges = 0;
+        for(int p = 0; p < csize; p++)
+            for(int q = p + 1; q < csize; q++)
+                index[nedges++] = xpos_undirected(s[p], s[q], inst);
+        rowbatch_add(b, csize - 1, 'L', nedges, index, value, "SEC(%d,%d,%d)", it, c, csize);
+        print(inst, 'D', 3, "Added constraints for component %d of size %d", c, csize);
+    }
+    rowbatch_submit(inst, b, false);
+
     free(index);
     free(value);
+    free(start);
+    free(nodes);
+}
+
+/**
+ * Keep the tour if it's the best one.
+ *
+ * @param inst general instance
+ * @param succ tour
+ * @param z tour cost
+ */
+static void keep_tour(instance *inst, const int *succ, double z){
+    if(z < inst->zbest){
+        inst->zbest = z;
+        if(inst->succ == NULL) inst->succ = (int *) malloc(inst->nnodes * sizeof(int));
+        memcpy(inst->succ, succ, inst->nnodes * sizeof(int));
+    }
+}
+
+/**
+ * Patch the master solution into a tour, refine it by 2-opt and keep it if it's the best one.
+ *
+ * @param inst general instance
+ * @param succ master cycles
+ * @param comp components
+ * @param ncomp number of components
+ * @return tour cost
+ */
+static double patched_tour(instance *inst, int *succ, int *comp, int ncomp){
+    tour *t = new_tour(inst->nnodes);
+    nodequeue *q = new_nodequeue(inst->nnodes);
+    double z = patch_tour(inst, succ, comp, ncomp, t, q);
+    free_nodequeue(q);
+    free_tour(t);
+
+    keep_tour(inst, succ, z);
+    return z;
 }
 
 /**
  * Benders loop method.
  * Solve iteratively TSP generating on the fly SECs.
- * Use directed graphs.
+ * Masters are solved to a loose gap first (BENDERS_GAP0), which is tightened at each iteration;
+ * the subtours are patched into a tour which is passed as MIP start of the next master.
+ * Use undirected graphs.
  *
  * @param inst general instance
- * @param env CPLEX environment
- * @param lp CPLEX linear problem
  */
 void loop_benders(instance *inst) {
     build_model_base_undirected(inst);
 
     int tot_cols = CPXgetnumcols(inst->CPXenv, inst->CPXlp);
+    inst->ncols = tot_cols;
+    inst->zbest = CPX_INFBOUND;
+
+    // heuristic warm start: the first master starts from it
+    if(inst->ws_cons != CHLAST){
+        warm_start(inst, GREEDY);
+        inst->directed = false;
+        add_mipstarts(inst);
+    }
+
     int ncomp = inst->nnodes;
     double *xstar = (double *) malloc(tot_cols * sizeof(double));
     int *succ = (int *) malloc(inst->nnodes * sizeof(int));
     int *comp = (int *) malloc(inst->nnodes * sizeof(int));
+    int *varindices = (int *) malloc(tot_cols * sizeof(int));
+    for(int i = 0; i < tot_cols; i++) varindices[i] = i;
+    int beg[] = {0};
+    int effort[] = {CPX_MIPSTART_AUTO};
 
     print(inst, 'I', 1, "Optimization started! Please wait...");
 
     struct timeval ctime;
-    long eltime;
+    double gap = BENDERS_GAP0;
+    bool proven = false;    // the best tour matches the lower bound
+    bool optimal = false;   // the last master is an optimal tour
 
     int it = 0;
     while(true) {
         it++;
-        if(inst->verbose >= 2) printf(BOLDGREEN "[Benders] Iteration #%d...\n" RESET, it);
+        if(inst->verbose >= 2) printf(BOLDGREEN "[Benders] Iteration #%d (gap %g)...\n" RESET, it, gap);
+        CPXsetdblparam(inst->CPXenv, CPXPARAM_MIP_Tolerances_MIPGap, gap);
         CPXmipopt(inst->CPXenv, inst->CPXlp);
 
         // get xstar
         if(CPXgetx(inst->CPXenv, inst->CPXlp, xstar, 0, tot_cols - 1)) {
-            printerr(inst, "CPXgetx(): error retrieving xstar!");
+            if(inst->succ == NULL){
+                free(xstar);
+                printerr(inst, "CPXgetx(): error retrieving xstar!");
+            }
+            print(inst, 'W', 1, "Benders: no master solution");
+            inst->status = CPXMIP_TIME_LIM_FEAS;
+            break;
         }
-        inst->xstar = xstar;
 
         // find connected components
-        findccomp(inst, inst->xstar, &ncomp, succ, comp);
+        findccomp(inst, xstar, &ncomp, succ, comp);
 
         if(inst->verbose >= 2)
             printf(BOLDGREEN "[Benders] Found %d connected components\n" RESET, ncomp);
@@ -112,37 +164,69 @@ void loop_benders(instance *inst) {
         CPXgetobjval(inst->CPXenv, inst->CPXlp, &inst->zstar);
         print(inst, 'D', 2, "Found z* = %f", inst->zstar);
 
-        if(ncomp == 1)
-            break;
+        if(ncomp == 1){
+            keep_tour(inst, succ, cost_succ(inst, succ));
+            if(gap <= BENDERS_GAPMIN){
+                optimal = true;
+                break;
+            }
 
-        // set new lower bound TODO remove
-        //CPXsetdblparam(inst->CPXenv, CPX_PARAM_OBJLLIM, inst->zstar);
+            // the master solution is a tour: solve again to the final gap, starting from it
+            gap = BENDERS_GAPMIN;
+            if(CPXaddmipstarts(inst->CPXenv, inst->CPXlp, 1, tot_cols, beg, varindices, xstar, effort, NULL))
+                print(inst, 'W', 1, "Can't add warm start");
+        }else{
+            // stop if the patched tour matches the lower bound
+            double z = patched_tour(inst, succ, comp, ncomp);
+            double lb = -CPX_INFBOUND;
+            CPXgetbestobjval(inst->CPXenv, inst->CPXlp, &lb);
+            print(inst, 'D', 2, "Patched tour z = %f, lower bound = %f", z, lb);
+            if(inst->zbest <= lb + BENDERS_GAPMIN * fabs(lb)){
+                proven = true;
+                break;
+            }
+        }
 
         // check and update time limit
         gettimeofday(&ctime, NULL);
-        eltime = ctime.tv_sec - inst->tstart.tv_sec;
-        if((double) eltime >= inst->time_limit) {
+        double eltime = (double) (ctime.tv_sec - inst->tstart.tv_sec);
+        if(eltime >= inst->time_limit) {
             print(inst, 'W', 1, "Time limit reached!");
-            inst->status = CPXMIP_TIME_LIM_INFEAS;
+            inst->status = (inst->zbest < CPX_INFBOUND) ? CPXMIP_TIME_LIM_FEAS : CPXMIP_TIME_LIM_INFEAS;
             break;
         }
-        print(inst, 'D', 3, "New time limit: %ld", inst->time_limit - (double) eltime);
-        if(CPXsetdblparam(inst->CPXenv, CPXPARAM_TimeLimit, (double) (inst->time_limit - (double) eltime)))
+        print(inst, 'D', 3, "New time limit: %f", inst->time_limit - eltime);
+        if(CPXsetdblparam(inst->CPXenv, CPXPARAM_TimeLimit, inst->time_limit - eltime))
             print(inst, 'W', 1, "Error setting time limit.");
 
-        if(inst->time_limit >= 4) {
-            print(inst, 'I', '4', "Press ENTER to continue...");
-            plot(inst, inst->xstar);
-            printerr(inst, "Exiting...");
+        if(ncomp > 1){
+            // add sec for connected components (they are kept for the next iterations)
+            updconstr(inst, ncomp, comp, it);
+
+            // warm start from the best patched tour
+            double *xbest = succtox(inst, inst->succ, false);
+            if(CPXaddmipstarts(inst->CPXenv, inst->CPXlp, 1, tot_cols, beg, varindices, xbest, effort, NULL))
+                print(inst, 'W', 1, "Can't add warm start");
+            free(xbest);
+
+            gap = (gap * BENDERS_GAPDECAY > BENDERS_GAPMIN) ? gap * BENDERS_GAPDECAY : BENDERS_GAPMIN;
         }
-        // add sec for connected components
-        updconstr(inst, ncomp, comp, it);
     }
 
+    // return the best tour unless the last master is optimal
+    if(!optimal && inst->succ != NULL){
+        free(xstar);
+        xstar = succtox(inst, inst->succ, false);
+        inst->zstar = inst->zbest;
+        if(proven) inst->status = CPXMIP_OPTIMAL;
+    }
+    inst->xstar = xstar;
+
     free(succ);
     free(comp);
+    free(varindices);
 }
 
 void get_solution_Benders(instance *inst){
     get_solution_base_undirected(inst);
-}
\ No newline at end of file
+}
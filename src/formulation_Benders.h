@@ -9,6 +9,12 @@
 
 #include "formulation_commons.h"
 
+#define BENDERS_GAP0 0.1        // MIP gap of the first master
+#define BENDERS_GAPDECAY 0.5    // gap reduction at each iteration
+#define BENDERS_GAPMIN 1e-4     // final MIP gap
+
+void updconstr(instance *inst, int ncomp, const int *comp, int it);
+
 void loop_benders(instance *inst);
 
 void get_solution_Benders(instance *inst);
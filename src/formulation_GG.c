@@ -30,30 +30,18 @@ int ypos(int i, int j, instance *inst){
  * @param inst general instance
  */
 void add_flow_vars(instance *inst){
-    char *cname[] = {(char *) malloc(BUFLEN)};
-
-    char integer = 'I';
+    colbatch *b = new_colbatch(inst, inst->nnodes * inst->nnodes);
 
     // add y flow variables
     for(int i = 0; i < inst->nnodes; i++){
         for(int j = 0; j < inst->nnodes; j++) {
-            snprintf(cname[0], BUFLEN, "y(%d,%d)", i + 1, j + 1);
-            //printf("y(%d,%d) = %s\n", i+1, j+1, cname[0]);
-            double obj = 0;
-            double lb = 0;
             double ub = ((i == j) || (j == 0)) ? 0 : inst->nnodes - 1; // was 2
-            if (CPXnewcols(inst->CPXenv, inst->CPXlp, 1, &obj, &lb, &ub, &integer, cname)) {
-                free(cname[0]);
-                printerr(inst, "CPXnewcols() error.");
-            }
+            int pos = colbatch_add(b, 0, 0, ub, 'I', "y(%d,%d)", i + 1, j + 1);
             // check ypos on the fly
-            if (CPXgetnumcols(inst->CPXenv, inst->CPXlp) - 1 != ypos(i, j, inst)) {
-                free(cname[0]);
-                printerr(inst, "ypos() got a bad index!");
-            }
+            if(pos != ypos(i, j, inst)) printerr(inst, "ypos() got a bad index!");
         }
     }
-    free(cname[0]);
+    colbatch_submit(inst, b);
 }
 
 /**
@@ -62,40 +50,30 @@ void add_flow_vars(instance *inst){
  * @param inst general instance
  */
 void add_flow_constraints(instance *inst){
-    char *rname[] = {(char *) malloc(BUFLEN)};
+    int n = inst->nnodes;
+    rowbatch *b = new_rowbatch(inst, n - 1, 2 * (n - 1) * (n - 1));
 
     // add flow constraints in(h) = out(h) +1 for h!=1
-    int nnz = 2 * inst->nnodes;
-    int index[nnz];
-    double value[nnz];
-    double rhs = 1;
-    char sense = 'E';
-    int izero = 0;
-    for(int h = 1; h < inst->nnodes; h++){
-        snprintf(rname[0], BUFLEN, "flow(%d)", h + 1);
+    int nnz = 2 * (n - 1);
+    int *index = (int *) malloc(nnz * sizeof(int));
+    double *value = (double *) malloc(nnz * sizeof(double));
+    for(int h = 1; h < n; h++){
         // build index value array
         int idx = 0;
-        for(int i = 0; i < inst->nnodes; i++) {
+        for(int i = 0; i < n; i++) {
+            if(i == h) continue;
             index[idx] = ypos(i, h, inst);
-            value[idx] = (h!=i)?1:0;
-            index[inst->nnodes + idx] = ypos(h, i, inst);
-            value[inst->nnodes + idx] = (h != i) ? -1 : 0;
+            value[idx] = 1;
+            index[n - 1 + idx] = ypos(h, i, inst);
+            value[n - 1 + idx] = -1;
             idx++;
         }
-        if(inst->lazy) {
-            if(CPXaddlazyconstraints(inst->CPXenv, inst->CPXlp, 1, nnz, &rhs, &sense, &izero, index, value, rname)) {
-                free(rname[0]);
-                printerr(inst, "CPXaddlazyconstraints() error.");
-            }
-        }else
-            if (CPXaddrows(inst->CPXenv, inst->CPXlp, 0, 1, nnz, &rhs, &sense, &izero, index, value, NULL, rname)) {
-                free(rname[0]);
-                printerr(inst, "CPXaddrows() error!");
-            }
-
+        rowbatch_add(b, 1, 'E', nnz, index, value, "flow(%d)", h + 1);
     }
+    rowbatch_submit(inst, b, inst->lazy);
 
-    free(rname[0]);
+    free(index);
+    free(value);
 }
 
 /**
@@ -103,62 +81,70 @@ void add_flow_constraints(instance *inst){
  *
  * N.B. Need to add edge binary variables first!
  * @param inst general instance
- * @param env CPLEX envinronment
- * @param lp CPLEX LP
  */
 void add_linking_constraints(instance *inst){
-    char *rname[] = {(char *) calloc(BUFLEN, sizeof(char))};
+    int n = inst->nnodes;
+    rowbatch *b = new_rowbatch(inst, (n - 1) * (n - 1), 2 * (n - 1) * (n - 1));
 
     int nnz = 2;
     int index[nnz];
     double value[nnz];
-    double rhs = 0;
-    char sense = 'L';
-    int izero = 0;
-    // linking constraints: y_ij <= (n-2) * x_ij, for each i != 1 != j
-    for(int i = 1; i < inst->nnodes; i++){
-        for(int j = 1; j < inst->nnodes; j++) {
+    // linking constraints: y_ij <= (n-2) * x_ij, for each i != 1 != j (y_ii and x_ii are fixed to 0)
+    value[0] = 1;
+    value[1] = -n + 2;
+    for(int i = 1; i < n; i++){
+        for(int j = 1; j < n; j++) {
+            if(i == j) continue;
             index[0] = ypos(i, j, inst);
-            value[0] = 1;
             index[1] = xpos_directed(i, j, inst);
-            value[1] = -inst->nnodes + 2;
-            snprintf(rname[0], BUFLEN, "link(%d,%d)", i + 1, j + 1);
-            if(inst->lazy){
-                if(CPXaddlazyconstraints(inst->CPXenv, inst->CPXlp, 1, nnz, &rhs, &sense, &izero, index, value, rname)) {
-                    free(rname[0]);
-                    printerr(inst, "CPXaddlazyconstraints() error!");
-                }
-            }else
-                if(CPXaddrows(inst->CPXenv, inst->CPXlp, 0, 1, nnz, &rhs, &sense, &izero, index, value, NULL, rname)){
-                    free(rname[0]);
-                    printerr(inst, "CPXaddrows() error!");
-                }
+            rowbatch_add(b, 0, 'L', nnz, index, value, "link(%d,%d)", i + 1, j + 1);
         }
     }
 
     // linking for 1: y_1j = (<=) (n-1)x_1j
-    rhs = 0;
-    sense = 'L';
-    if(inst->formulation == GGi) sense = 'E';
-    nnz = 2; // we can reuse previous arrays!
-    for(int j = 1; j < inst->nnodes; j++){
-        snprintf(rname[0], BUFLEN, "link(1, %d)", j + 1);
+    char sense = (inst->formulation == GGi || inst->formulation == GGL) ? 'E' : 'L';
+    value[1] = -n + 1;
+    for(int j = 1; j < n; j++){
         index[0] = ypos(0, j, inst);
-        value[0] = 1;
         index[1] = xpos_directed(0, j, inst);
-        value[1] = -inst->nnodes + 1;
-        if(inst->lazy) {
-            if(CPXaddlazyconstraints(inst->CPXenv, inst->CPXlp, 1, nnz, &rhs, &sense, &izero, index, value, rname)) {
-                free(rname[0]);
-                printerr(inst, "CPXaddlazyconstraints() error!");
-            }
-        }else
-        if(CPXaddrows(inst->CPXenv, inst->CPXlp, 0, 1, nnz, &rhs, &sense, &izero, index, value, NULL, rname)) {
-            free(rname[0]);
-            printerr(inst, "CPXaddrows() error!");
+        rowbatch_add(b, 0, sense, nnz, index, value, "link(1, %d)", j + 1);
+    }
+    rowbatch_submit(inst, b, inst->lazy);
+}
+
+/**
+ * Add lifted linking constraints, for each i != 1 != j:
+ * an arc carries at least the unit of flow of its head, i.e. y_ij >= x_ij, and at most n-2 units
+ * only when it leaves the first node of the tour, i.e. y_ij <= (n-3) x_ij + x_1i.
+ *
+ * N.B. Need to add edge binary variables first!
+ * @param inst general instance
+ */
+void add_lifted_linking_constraints(instance *inst){
+    int n = inst->nnodes;
+    rowbatch *b = new_rowbatch(inst, 2 * (n - 1) * (n - 2), 5 * (n - 1) * (n - 2));
+
+    int index[3];
+    double value[3];
+    for(int i = 1; i < n; i++){
+        for(int j = 1; j < n; j++) {
+            if(i == j) continue;
+            index[0] = ypos(i, j, inst);
+            index[1] = xpos_directed(i, j, inst);
+            index[2] = xpos_directed(0, i, inst);
+
+            // y_ij - x_ij >= 0
+            value[0] = 1;
+            value[1] = -1;
+            rowbatch_add(b, 0, 'G', 2, index, value, "link_lb(%d,%d)", i + 1, j + 1);
+
+            // y_ij - (n-3) x_ij - x_1i <= 0
+            value[1] = -n + 3;
+            value[2] = -1;
+            rowbatch_add(b, 0, 'L', 3, index, value, "link_ub(%d,%d)", i + 1, j + 1);
         }
     }
-    free(rname[0]);
+    rowbatch_submit(inst, b, inst->lazy);
 }
 
 /**
@@ -176,6 +162,9 @@ void build_model_GG(instance *inst) {
     add_flow_constraints(inst);
 
     add_linking_constraints(inst);
+
+    if(inst->formulation == GGL)
+        add_lifted_linking_constraints(inst);
 }
 
 /**
@@ -18,6 +18,8 @@ void add_flow_constraints(instance *inst);
 
 void add_linking_constraints(instance *inst);
 
+void add_lifted_linking_constraints(instance *inst);
+
 void build_model_GG(instance *inst);
 
 void get_solution_GG(instance *inst);
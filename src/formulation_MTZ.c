@@ -14,67 +14,74 @@ int upos(int i, instance *inst){
 }
 
 void add_uconsistency_vars(instance *inst){
-    char *cname[] = {calloc(BUFLEN, sizeof(char))};
-
-    char integer = 'I';
-    int err;
+    colbatch *b = new_colbatch(inst, inst->nnodes);
 
     // add integer vars u(i) for each node i
     for(int i = 0; i < inst->nnodes; i++){
-        snprintf(cname[0], BUFLEN, "u(%d)", i+1);
-        double obj = 0;
-        double lb = 0;
         double ub = i ? (inst->nnodes - 2) : 0;
-        if((err = CPXnewcols(inst->CPXenv, inst->CPXlp, 1, &obj, &lb, &ub, &integer, cname))) {
-            printf(BOLDRED "[ERROR] CPXnewcols(): error code %d\n" RESET, err);
-            free_instance(inst); free(cname[0]);
-            exit(1);
-        }
-        // check xpos_undirected on the fly (can be removed if I'm sure it's ok)
-        if(CPXgetnumcols(inst->CPXenv, inst->CPXlp)-1 != upos(i, inst)) {
-            printf(BOLDRED "[ERROR] upos() got a bad index!\n" RESET);
-            free_instance(inst); free(cname[0]);
-            exit(1);
-        }
+        int pos = colbatch_add(b, 0, 0, ub, 'I', "u(%d)", i+1);
+        // check upos on the fly (can be removed if I'm sure it's ok)
+        if(pos != upos(i, inst)) printerr(inst, "upos() got a bad index!");
     }
-    free(cname[0]);
+    colbatch_submit(inst, b);
 }
 
 void add_uconsistency_constraints(instance *inst){
-    int err;
-    char *rname[] = {calloc(BUFLEN, sizeof(char))};
+    int n = inst->nnodes;
+    // Desrochers-Laporte lifting: the reverse arc x(j,i) gets coefficient n - 3
+    int nnz = (inst->formulation == MTZL && n > 3) ? 4 : 3;
+    rowbatch *b = new_rowbatch(inst, (n - 1) * (n - 2), nnz * (n - 1) * (n - 2));
 
-    int nnz = 3;
-    int index[nnz];
-    double value[nnz];
-    int izero = 0;
+    int index[4];
+    double value[4];
 
     int big_M = inst->nnodes - 1; // use big M trick
     double rhs = big_M - 1;
-    char sense = 'L';
+    value[0] = 1;
+    value[1] = -1;
+    value[2] = big_M;
+    value[3] = n - 3;
     for(int i = 1; i < inst->nnodes; i++)
         for(int j = 1; j < inst->nnodes; j++){
             if(i == j) continue;
-            snprintf(rname[0], BUFLEN, "u_consistency(%d,%d)", i + 1, j + 1);
             index[0] = upos(i, inst);
-            value[0] = 1;
             index[1] = upos(j, inst);
-            value[1] = -1;
             index[2] = xpos_directed(i, j, inst);
-            value[2] = big_M;
-            if(inst->lazy) {
-                if ((err = CPXaddlazyconstraints(inst->CPXenv, inst->CPXlp, 1, nnz, &rhs, &sense, &izero, index, value, rname))) {
-                    printf(BOLDRED "[ERROR] CPXaddlazyconstraints() error code %d\n" RESET, err);
-                    exit(1);
-                }
-            }else
-                if ((err = CPXaddrows(inst->CPXenv, inst->CPXlp, 0, 1, nnz, &rhs, &sense, &izero, index, value, NULL, rname))) {
-                    printf(BOLDRED "[ERROR] CPXaddrows() error code %d\n" RESET, err);
-                    exit(1);
-                }
+            index[3] = xpos_directed(j, i, inst);
+            rowbatch_add(b, rhs, 'L', nnz, index, value, "u_consistency(%d,%d)", i + 1, j + 1);
         }
+    rowbatch_submit(inst, b, inst->lazy);
+}
 
-    free(rname[0]);
+/**
+ * Add the lifted bounds of u(i), for i != 1:
+ * u(i) is 0 iff i follows 1 and it is n-2 iff 1 follows i, otherwise it is in [1, n-3].
+ *
+ * @param inst general instance
+ */
+void add_ubound_constraints(instance *inst){
+    int n = inst->nnodes;
+    rowbatch *b = new_rowbatch(inst, 2 * (n - 1), 6 * (n - 1));
+
+    int index[3];
+    double value[3];
+    for(int i = 1; i < n; i++){
+        index[0] = upos(i, inst);
+        index[1] = xpos_directed(0, i, inst);
+        index[2] = xpos_directed(i, 0, inst);
+
+        // u(i) + x(1,i) - (n-3) x(i,1) >= 1
+        value[0] = 1;
+        value[1] = 1;
+        value[2] = -(n - 3);
+        rowbatch_add(b, 1, 'G', 3, index, value, "u_lb(%d)", i + 1);
+
+        // u(i) + (n-3) x(1,i) - x(i,1) <= n-3
+        value[1] = n - 3;
+        value[2] = -1;
+        rowbatch_add(b, n - 3, 'L', 3, index, value, "u_ub(%d)", i + 1);
+    }
+    rowbatch_submit(inst, b, false);
 }
 
 void build_model_MTZ(instance *inst) {
@@ -84,6 +91,9 @@ void build_model_MTZ(instance *inst) {
 
     add_uconsistency_constraints(inst);
 
+    if(inst->formulation == MTZL && inst->nnodes > 3)
+        add_ubound_constraints(inst);
+
     // set strict integrality tolerance because of big M contraints
     CPXsetdblparam(inst->CPXenv, CPX_PARAM_EPINT, 1e-09); // default: 1e-05
 }
@@ -16,6 +16,8 @@ void add_uconsistency_vars(instance *inst);
 
 void add_uconsistency_constraints(instance *inst);
 
+void add_ubound_constraints(instance *inst);
+
 void build_model_MTZ(instance *inst);
 
 void get_solution_MTZ(instance *inst);
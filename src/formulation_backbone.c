@@ -0,0 +1,69 @@
+//
+// Created by enrico on 18/07/21.
+//
+
+#include "formulation_backbone.h"
+#include "heuristics.h"
+
+/**
+ * Tour merging: the model of the cuts formulation restricted to the union of the edges of an elite pool
+ * of local optima (greedy-grasp + 2-opt). The edges shared by all the tours (the backbone) are fixed to 1.
+ *
+ * @param inst general instance
+ */
+void build_model_backbone(instance *inst){
+    int n = inst->nnodes;
+
+    // elite pool
+    warm_start_pool(inst, GREEDYGRASP, BACKBONE_NTOURS);
+    inst->directed = false;
+    tourpool *elite = inst->elite;
+
+    // union of the elite edges, and number of tours using each one
+    free_edgeset(inst->edges);
+    inst->edges = new_edgeset(n, n * elite->size);
+    int *count = (int *) calloc(n * elite->size, sizeof(int));
+    for(int s = 0; s < elite->size; s++)
+        for(int i = 0; i < n; i++)
+            count[edgeset_add(inst->edges, i, elite->succ[s][i])]++;
+
+    build_model_base_undirected(inst);
+    inst->ncols = CPXgetnumcols(inst->CPXenv, inst->CPXlp);
+    install_cuts_callback(inst, ncores());
+
+    // fix the backbone
+    int *indices = (int *) malloc(n * sizeof(int));
+    char *lu = (char *) malloc(n * sizeof(char));
+    double *bd = (double *) malloc(n * sizeof(double));
+    int nfixed = 0;
+    for(int k = 0; k < inst->edges->n; k++){
+        if(count[k] < elite->size) continue;
+        indices[nfixed] = k;
+        lu[nfixed] = 'L';
+        bd[nfixed++] = 1;
+    }
+    if(nfixed > 0 && CPXchgbds(inst->CPXenv, inst->CPXlp, nfixed, indices, lu, bd))
+        printerr(inst, "CPXchgbds(): error fixing the backbone");
+    print(inst, 'I', 1, "Backbone: %d tours, %d edges, %d fixed", elite->size, inst->edges->n, nfixed);
+
+    add_mipstarts(inst);
+
+    free(count);
+    free(indices);
+    free(lu);
+    free(bd);
+}
+
+/**
+ * Solve the merged model: its optimum is only a heuristic tour of the full graph.
+ *
+ * @param inst general instance
+ */
+void solve_backbone(instance *inst){
+    if(CPXmipopt(inst->CPXenv, inst->CPXlp))
+        printerr(inst, "CPXmipopt() error!");
+
+    inst->status = CPXgetstat(inst->CPXenv, inst->CPXlp);
+    if(inst->status == CPXMIP_OPTIMAL || inst->status == CPXMIP_OPTIMAL_TOL)
+        inst->status = CPXMIP_TIME_LIM_FEAS;
+}
@@ -0,0 +1,17 @@
+//
+// Created by enrico on 18/07/21.
+//
+
+#ifndef TSP_OP2_FORMULATION_BACKBONE_H
+#define TSP_OP2_FORMULATION_BACKBONE_H
+
+#include "utils.h"
+#include "formulation_cuts.h"
+
+#define BACKBONE_NTOURS 10  // size of the elite pool
+
+void build_model_backbone(instance *inst);
+
+void solve_backbone(instance *inst);
+
+#endif //TSP_OP2_FORMULATION_BACKBONE_H
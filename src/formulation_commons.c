@@ -2,7 +2,151 @@
 // TSP shared functions among formulations
 //
 
+#include <stdarg.h>
+#include <float.h>
 #include "formulation_commons.h"
+#include "candidates.h"
+
+// ===== BATCHED MODEL CONSTRUCTION =====
+
+/**
+ * Column and row names are only needed in the LP file, which is saved when verbose >= 1:
+ * building thousands of them with snprintf costs more than the model itself.
+ *
+ * @param inst general instance
+ * @return true if the builders have to name columns and rows
+ */
+bool use_names(instance *inst){
+    return inst->verbose >= 1;
+}
+
+static char ** new_names(int count){
+    char **name = (char **) malloc((count > 0 ? count : 1) * sizeof(char *));
+    name[0] = (char *) calloc((count > 0 ? count : 1) * NAMELEN, sizeof(char));
+    for(int k = 1; k < count; k++)
+        name[k] = name[0] + k * NAMELEN;
+    return name;
+}
+
+static void free_names(char **name){
+    if(name == NULL) return;
+    free(name[0]);
+    free(name);
+}
+
+/**
+ * Start a batch of columns appended after the current ones.
+ *
+ * @param inst general instance
+ * @param count max number of columns
+ * @return the (empty) batch
+ */
+colbatch * new_colbatch(instance *inst, int count){
+    colbatch *b = (colbatch *) malloc(sizeof(colbatch));
+    b->first = CPXgetnumcols(inst->CPXenv, inst->CPXlp);
+    b->n = 0;
+    b->cap = count;
+    b->obj = (double *) malloc(count * sizeof(double));
+    b->lb = (double *) malloc(count * sizeof(double));
+    b->ub = (double *) malloc(count * sizeof(double));
+    b->type = (char *) malloc(count * sizeof(char));
+    b->name = use_names(inst) ? new_names(count) : NULL;
+    return b;
+}
+
+/**
+ * Append a column to the batch; the name is formatted only if needed.
+ *
+ * @return CPLEX index the column will have, -1 if the batch is full
+ */
+int colbatch_add(colbatch *b, double obj, double lb, double ub, char type, const char *fmt, ...){
+    if(b->n >= b->cap) return -1;
+    b->obj[b->n] = obj;
+    b->lb[b->n] = lb;
+    b->ub[b->n] = ub;
+    b->type[b->n] = type;
+    if(b->name != NULL){
+        va_list args;
+        va_start(args, fmt);
+        vsnprintf(b->name[b->n], NAMELEN, fmt, args);
+        va_end(args);
+    }
+    return b->first + b->n++;
+}
+
+/**
+ * Add all the columns of the batch with a single CPXnewcols() and free it.
+ */
+void colbatch_submit(instance *inst, colbatch *b){
+    int err = CPXnewcols(inst->CPXenv, inst->CPXlp, b->n, b->obj, b->lb, b->ub, b->type, b->name);
+    int n = b->first + b->n;
+    free(b->obj); free(b->lb); free(b->ub); free(b->type);
+    free_names(b->name);
+    free(b);
+    if(err) printerr(inst, "CPXnewcols(): error code %d", err);
+    if(CPXgetnumcols(inst->CPXenv, inst->CPXlp) != n) printerr(inst, "CPXnewcols(): bad number of columns!");
+}
+
+/**
+ * Start a batch of rows.
+ *
+ * @param inst general instance
+ * @param count max number of rows
+ * @param nnz max number of nonzeros
+ * @return the (empty) batch
+ */
+rowbatch * new_rowbatch(instance *inst, int count, int nnz){
+    rowbatch *b = (rowbatch *) malloc(sizeof(rowbatch));
+    b->n = b->nnz = 0;
+    b->cap = count;
+    b->nzcap = nnz;
+    b->rhs = (double *) malloc(count * sizeof(double));
+    b->sense = (char *) malloc(count * sizeof(char));
+    b->beg = (int *) malloc((count + 1) * sizeof(int));
+    b->ind = (int *) malloc(nnz * sizeof(int));
+    b->val = (double *) malloc(nnz * sizeof(double));
+    b->name = use_names(inst) ? new_names(count) : NULL;
+    return b;
+}
+
+/**
+ * Append a row (coefficients are copied) to the batch; the name is formatted only if needed.
+ *
+ * @return row index inside the batch, -1 if the batch is full
+ */
+int rowbatch_add(rowbatch *b, double rhs, char sense, int nnz, const int *ind, const double *val, const char *fmt, ...){
+    if(b->n >= b->cap || b->nnz + nnz > b->nzcap) return -1;
+    b->rhs[b->n] = rhs;
+    b->sense[b->n] = sense;
+    b->beg[b->n] = b->nnz;
+    memcpy(b->ind + b->nnz, ind, nnz * sizeof(int));
+    memcpy(b->val + b->nnz, val, nnz * sizeof(double));
+    b->nnz += nnz;
+    if(b->name != NULL){
+        va_list args;
+        va_start(args, fmt);
+        vsnprintf(b->name[b->n], NAMELEN, fmt, args);
+        va_end(args);
+    }
+    return b->n++;
+}
+
+/**
+ * Add all the rows of the batch with a single CPXaddrows() (or CPXaddlazyconstraints()) and free it.
+ */
+void rowbatch_submit(instance *inst, rowbatch *b, bool lazy){
+    int err;
+    if(lazy)
+        err = CPXaddlazyconstraints(inst->CPXenv, inst->CPXlp, b->n, b->nnz, b->rhs, b->sense, b->beg, b->ind, b->val,
+                                    b->name);
+    else
+        err = CPXaddrows(inst->CPXenv, inst->CPXlp, 0, b->n, b->nnz, b->rhs, b->sense, b->beg, b->ind, b->val,
+                         NULL, b->name);
+    free(b->rhs); free(b->sense); free(b->beg); free(b->ind); free(b->val);
+    free_names(b->name);
+    free(b);
+    if(err) printerr(inst, "%s(): error code %d", lazy ? "CPXaddlazyconstraints" : "CPXaddrows", err);
+}
 
 // ===== DIRECTED GRAPH FUNCTIONS =====
 
@@ -17,99 +161,55 @@ int xpos_directed(int i, int j, instance *inst){
 }
 
 void add_x_vars_directed(instance *inst){
-    char binary = 'B';
-    int err;
+    colbatch *b = new_colbatch(inst, inst->nnodes * inst->nnodes);
 
-    // allocate array for variable's name with trick
-    char *cname[] = { (char *) calloc(BUFLEN, sizeof(char))};
-
-    // add binary vars x(i,j) for i != j
-    // one for each edge without auto-loops
+    // add binary vars x(i,j), auto-loops are kept (fixed to 0) to have the n x n layout of xpos_directed()
     for(int i = 0; i < inst->nnodes; i++ ){
         for (int j = 0; j < inst->nnodes; j++ ){
-            // define variable name
-            snprintf(cname[0], BUFLEN, "x(%d,%d)", i+1,j+1);
-            // define its cost
-            double obj = cost(i, j, inst); // cost == distance
-            // define its lower bound
-            double lb = 0.0;
-            // define its upper bound
-            double ub = (i != j)?1:0;
-            if((err = CPXnewcols(inst->CPXenv, inst->CPXlp, 1, &obj, &lb, &ub, &binary, cname))) {
-                printf(BOLDRED "[ERROR] CPXnewcols(): error code %d\n" RESET, err);
-                exit(1);
-            }
-            // check xpos_undirected on the fly (can be removed if I'm sure it's ok)
-            if (CPXgetnumcols(inst->CPXenv,inst->CPXlp)-1 != xpos_directed(i, j, inst)) {
-                printf(BOLDRED "[ERROR] xpos_directed() got a bad index!\n" RESET);
-                free(cname[0]);
-                free_instance(inst);
-                exit(1);
-            }
+            // cost == distance
+            int pos = colbatch_add(b, cost(i, j, inst), 0.0, (i != j) ? 1 : 0, 'B', "x(%d,%d)", i+1, j+1);
+            // check xpos_directed on the fly (can be removed if I'm sure it's ok)
+            if(pos != xpos_directed(i, j, inst)) printerr(inst, "xpos_directed() got a bad index!");
         }
     }
-    free(cname[0]);
+    colbatch_submit(inst, b);
 }
 
 void add_degree_constraints_directed(instance *inst){
-    char *rname[] = { (char *) calloc(BUFLEN, sizeof(char))};
-    int err;
-
-    // define right hand side
-    double rhs = 1.0;
-    // define the type of constraint (array) ('E' for equality)
-    char sense = 'E';
+    int nnz = inst->nnodes - 1;
+    rowbatch *b = new_rowbatch(inst, 2 * inst->nnodes, 2 * inst->nnodes * nnz);
+    int *index = (int *) malloc(nnz * sizeof(int));
+    double *value = (double *) malloc(nnz * sizeof(double));
+    for(int i = 0; i < nnz; i++) value[i] = 1;
 
     // add the 1 degree in and out constraints
     for(char out = 0; out < 2; out++)
         for(int h = 0; h < inst->nnodes; h++){
-            // define constraint name
-            snprintf(rname[0], BUFLEN, "degree_%s(%d)", out?"out":"in", h+1);
-            if ((err = CPXnewrows(inst->CPXenv, inst->CPXlp, 1, &rhs, &sense, NULL, rname)) ){
-                printf(BOLDRED "[ERROR] CPXnewrows() error code %d\n" RESET, err);
-                exit(1);
-            }
-            int lastrow_idx = CPXgetnumrows(inst->CPXenv, inst->CPXlp) - 1; // constraint index starts from 0
-            // change last row coefficients from 0 to 1
-            for(int i = 0; i < inst->nnodes; i++){
-                if(i == h) continue;
-                if ((err = CPXchgcoef(inst->CPXenv, inst->CPXlp, lastrow_idx,
-                                      xpos_directed(out ? h : i, out ? i : h, inst), 1.0))) {
-                    printf(BOLDRED "[ERROR] Cannot change coefficient: error code %d", err);
-                }
-            }
+            int k = 0;
+            for(int i = 0; i < inst->nnodes; i++)
+                if(i != h) index[k++] = xpos_directed(out ? h : i, out ? i : h, inst);
+            rowbatch_add(b, 1.0, 'E', nnz, index, value, "degree_%s(%d)", out?"out":"in", h+1);
         }
-    free(rname[0]);
+    rowbatch_submit(inst, b, false);
+
+    free(index);
+    free(value);
 }
 
 void add_SEC2_constraints_directed(instance *inst){
-    char *rname[] = { (char *) calloc(BUFLEN, sizeof(char))};
-
-    int err, err1, err2;
-    // add Subtour Elimination Constraints for 2 nodes
-    for(int i = 0; i < inst->nnodes; i++) {
-        for (int j = 0; j < inst->nnodes; j++) {
-            if (j == i) continue;
-            // define right hand side
-            double rhs = 1.0;
-            // define the type of constraint (array) ('E' for equality)
-            char sense = 'L';
-            // define constraint name
-            snprintf(rname[0], BUFLEN, "SEC2(%d,%d)", i + 1, j + 1);
-            if((err = CPXnewrows(inst->CPXenv, inst->CPXlp, 1, &rhs, &sense, NULL, rname))) {
-                printerr(inst, "[ERROR] CPXnewrows() error.");
-            }
-            int lastrow_idx = CPXgetnumrows(inst->CPXenv, inst->CPXlp) - 1; // constraint index starts from 0
-            // change last row coefficients from 0 to 1 or -1
-            err1 = CPXchgcoef(inst->CPXenv, inst->CPXlp, lastrow_idx, xpos_directed(i, j, inst), 1.0);
-            err2 = CPXchgcoef(inst->CPXenv, inst->CPXlp, lastrow_idx, xpos_directed(j, i, inst), 1.0);
-            if (err1 || err2) {
-                printf(BOLDRED "[ERROR] Cannot change coefficient: error code %d", err);
-            }
+    int n = inst->nnodes;
+    rowbatch *b = new_rowbatch(inst, n * (n - 1) / 2, n * (n - 1));
+    double value[] = {1.0, 1.0};
+
+    // add Subtour Elimination Constraints for 2 nodes: x(i,j) + x(j,i) <= 1
+    for(int i = 0; i < n; i++) {
+        for (int j = i + 1; j < n; j++) {
+            int index[] = {xpos_directed(i, j, inst), xpos_directed(j, i, inst)};
+            rowbatch_add(b, 1.0, 'L', 2, index, value, "SEC2(%d,%d)", i + 1, j + 1);
         }
     }
-
-    free(rname[0]);
+    // the lifted MTZ rows imply them in the LP: the lifted models can keep them in the lazy pool on request
+    rowbatch_submit(inst, b, inst->lazy && (inst->formulation == MTZL || inst->formulation == GGL));
 }
 
 void build_model_base_directed(instance *inst){
@@ -140,65 +240,83 @@ int xpos_undirected(int i, int j, instance *inst) {
 }
 
 void add_x_vars_undirected(instance *inst){
-    char binary = 'B';
+    // sparse model: one column for each edge of the set
+    if(inst->edges != NULL){
+        edgeset *es = inst->edges;
+        colbatch *b = new_colbatch(inst, es->n);
+        for(int k = 0; k < es->n; k++)
+            colbatch_add(b, cost(es->u[k], es->v[k], inst), 0.0, 1.0, 'B', "x(%d,%d)", es->u[k]+1, es->v[k]+1);
+        colbatch_submit(inst, b);
+        return;
+    }
 
-    // allocate array for variable's name with trick
-    char *cname[] = {(char *) calloc(BUFLEN, sizeof(char))}; // string array required by cplex for batch insertions
+    colbatch *b = new_colbatch(inst, inst->nnodes * (inst->nnodes - 1) / 2);
 
     // add binary vars x(i,j) for i < j
     // one for each edge
     for(int i = 0; i < inst->nnodes; i++){
         for(int j = i+1; j < inst->nnodes; j++){
-            // define variable name
-            snprintf(cname[0], BUFLEN, "x(%d,%d)", i+1,j+1);
-            // define its cost
-            double obj = cost(i, j, inst); // cost == distance
-            // define its lower bound
-            double lb = 0.0;
-            // define its upper bound
-            double ub = 1.0;
-            if(CPXnewcols(inst->CPXenv, inst->CPXlp, 1, &obj, &lb, &ub, &binary, cname)) {
-                free(cname[0]);
-                printerr(inst, "Cannot add columns!");
-            }
+            // cost == distance
+            int pos = colbatch_add(b, cost(i, j, inst), 0.0, 1.0, 'B', "x(%d,%d)", i+1, j+1);
             // check xpos_undirected on the fly (can be removed if I'm sure it's ok?)
-            if (CPXgetnumcols(inst->CPXenv,inst->CPXlp)-1 != xpos_undirected(i, j, inst)) {
-                free(cname[0]);
-                printerr(inst, "xpos_undirected() got a bad index!");
-            }
+            if(pos != xpos_undirected(i, j, inst)) printerr(inst, "xpos_undirected() got a bad index!");
         }
     }
-    free(cname[0]);
+    colbatch_submit(inst, b);
 }
 
 void add_degree_constraints_undirected(instance *inst){
-    char *rname[] = {(char *) calloc(BUFLEN, sizeof(char))};
+    int n = inst->nnodes;
+
+    // sparse model: rows are the node-edge incidence lists
+    if(inst->edges != NULL){
+        edgeset *es = inst->edges;
+        int *beg = calloc(n + 1, sizeof(int));
+        int *index = malloc(2 * es->n * sizeof(int));
+        double *value = malloc(2 * es->n * sizeof(double));
+        for(int k = 0; k < es->n; k++){
+            beg[es->u[k] + 1]++;
+            beg[es->v[k] + 1]++;
+        }
+        for(int h = 0; h < n; h++) beg[h + 1] += beg[h];
+        int *fill = malloc(n * sizeof(int));
+        memcpy(fill, beg, n * sizeof(int));
+        for(int k = 0; k < es->n; k++){
+            index[fill[es->u[k]]++] = k;
+            index[fill[es->v[k]]++] = k;
+        }
+        for(int k = 0; k < 2 * es->n; k++) value[k] = 1;
+
+        rowbatch *b = new_rowbatch(inst, n, 2 * es->n);
+        for(int h = 0; h < n; h++)
+            rowbatch_add(b, 2.0, 'E', beg[h + 1] - beg[h], index + beg[h], value + beg[h], "degree(%d)", h+1);
+        rowbatch_submit(inst, b, false);
+
+        free(beg);
+        free(fill);
+        free(index);
+        free(value);
+        return;
+    }
 
-    int nnz = inst->nnodes - 1;
-    int index[nnz];
-    double value[nnz];
+    int nnz = n - 1;
+    rowbatch *b = new_rowbatch(inst, n, n * nnz);
+    int *index = (int *) malloc(nnz * sizeof(int));
+    double *value = (double *) malloc(nnz * sizeof(double));
     for(int i = 0; i < nnz; i++) value[i] = 1;
 
-    // define right hand side
-    double rhs = 2.0;
-    // define the type of constraint (array) ('E' for equality)
-    char sense = 'E';
-    // define starting index
-    int izero = 0;
     // add the 2 degree constraints
-    for(int h = 0; h < inst->nnodes; h++){
+    for(int h = 0; h < n; h++){
         // build index array
         int k = 0;
-        for(int i = 0; i < inst->nnodes; i++)
+        for(int i = 0; i < n; i++)
             if(i != h) index[k++] = xpos_undirected(h, i, inst);
-        // define constraint name
-        snprintf(rname[0], BUFLEN, "degree(%d)", h+1);
-        if(CPXaddrows(inst->CPXenv, inst->CPXlp, 0, 1, nnz, &rhs, &sense, &izero, index, value, NULL, rname)) {
-            free(rname[0]);
-            printerr(inst, "Cannot add rows!");
-        }
+        rowbatch_add(b, 2.0, 'E', nnz, index, value, "degree(%d)", h+1);
     }
-    free(rname[0]);
+    rowbatch_submit(inst, b, false);
+
+    free(index);
+    free(value);
 }
 
 void build_model_base_undirected(instance *inst){
@@ -223,6 +341,20 @@ void get_solution_base_undirected(instance *inst){
     else
         xstar = inst->xstar;
 
+    // sparse model: columns don't follow xpos_undirected(), return the tour as successors
+    if(inst->edges != NULL){
+        int ncomp;
+        int *comp = (int *) malloc(inst->nnodes * sizeof(int));
+        free(inst->succ);
+        inst->succ = (int *) malloc(inst->nnodes * sizeof(int));
+        findccomp(inst, xstar, &ncomp, inst->succ, comp);
+        if(ncomp != 1) print(inst, 'W', 1, "Solution has %d components!", ncomp);
+        free(comp);
+        free(xstar);
+        inst->xstar = NULL;
+        return;
+    }
+
     // scan adjacency matrix induced by xstar and print values
     // deal with numeric errors
     double *rxstar = (double *) calloc(tot_cols, sizeof(double));
@@ -250,37 +382,198 @@ void get_solution_base_undirected(instance *inst){
  * @param comp returned array specifying components (initialized by caller)
  */
 void findccomp(instance *inst, const double *xstar, int *ncomp, int *succ, int *comp){
+    int n = inst->nnodes;
+
+    // adjacency lists of the selected edges: at most 2 neighbours each in an integer solution
+    int *adj = (int *) malloc(2 * n * sizeof(int));
+    for(int i = 0; i < 2 * n; i++) adj[i] = -1;
+    if(inst->edges != NULL){
+        edgeset *es = inst->edges;
+        for(int k = 0; k < es->n; k++){
+            if(xstar[k] <= 0.5) continue;
+            int i = es->u[k], j = es->v[k];
+            adj[2 * i + (adj[2 * i] >= 0)] = j;
+            adj[2 * j + (adj[2 * j] >= 0)] = i;
+        }
+    }else{
+        int k = 0;
+        for(int i = 0; i < n; i++)
+            for(int j = i + 1; j < n; j++, k++){
+                if(xstar[k] <= 0.5) continue;
+                adj[2 * i + (adj[2 * i] >= 0)] = j;
+                adj[2 * j + (adj[2 * j] >= 0)] = i;
+            }
+    }
+
     // initialize data structures
     *ncomp = 0;
-    for(int i = 0; i < inst->nnodes; i++)
+    for(int i = 0; i < n; i++)
         succ[i] = comp[i] = -1;
 
     // choose a node `start` and visit its connected component
-    for(int start = 0; start < inst->nnodes; start++){
+    for(int start = 0; start < n; start++){
         // skip visited nodes
         if(comp[start] >= 0) continue;
 
         // a new component is found
         (*ncomp)++;
         int curr = start;
-        bool done = false;
-        while(!done){ // go and visit the current component
-            // assign component to node `i`
+        while(true){ // go and visit the current component
+            // assign component to node `curr`
             comp[curr] = *ncomp;
-            done = true;
-            for(int next = 0; next < inst->nnodes; next++){
-                // the edge [curr, next] is selected in xstar and j was not visited before
-                if(curr != next && xstar[xpos_undirected(curr, next, inst)] > 0.5 && comp[next] == -1){
-                    // set `i` successor
-                    succ[curr] = next;
-                    // change current node
-                    curr = next;
-                    done = false;
-                    break;
-                }
-            }
+            int next = adj[2 * curr];
+            if(next < 0 || comp[next] != -1) next = adj[2 * curr + 1];
+            if(next < 0 || comp[next] != -1) break;
+            // set `curr` successor and move on
+            succ[curr] = next;
+            curr = next;
         }
         // last arc to close the cycle
         succ[curr] = start;
     } // go to the next component...
+
+    free(adj);
+}
+
+/**
+ * Reverse the cycle through node i.
+ */
+static void reverse_cycle(int *succ, int i){
+    int prev = i, curr = succ[i];
+    do{
+        int next = succ[curr];
+        succ[curr] = prev;
+        prev = curr;
+        curr = next;
+    }while(prev != i);
+}
+
+/**
+ * Patch the subtours of a master solution into a tour: the two cycles with the cheapest
+ * 2-edge exchange between them are merged until one is left, looking at candidate neighbours first.
+ *
+ * @param inst general instance
+ * @param succ cycles, returned as a tour
+ * @param comp components (from 1 to ncomp), changed
+ * @param ncomp number of components
+ */
+void patch(instance *inst, int *succ, int *comp, int ncomp){
+    int n = inst->nnodes;
+    const int *cand = candidates(inst);
+    int ncand = inst->ncand;
+
+    while(ncomp > 1){
+        double best = DBL_MAX;
+        int ba = -1, bb = -1;
+        bool breverse = false;
+
+        for(int pass = 0; pass < 2 && ba < 0; pass++){
+            for(int a = 0; a < n; a++){
+                int limit = pass ? n : ncand; // candidates first, then all nodes
+                for(int k = 0; k < limit; k++){
+                    int b = pass ? k : cand[a * ncand + k];
+                    if(comp[b] == comp[a]) continue;
+                    int a1 = succ[a], b1 = succ[b];
+                    double removed = cost(a, a1, inst) + cost(b, b1, inst);
+                    // a -> b1 ... b -> a1 (same orientation)
+                    double delta = cost(a, b1, inst) + cost(b, a1, inst) - removed;
+                    if(delta < best){ best = delta; ba = a; bb = b; breverse = false; }
+                    // a -> b ... b1 -> a1 (reversing the cycle of b)
+                    delta = cost(a, b, inst) + cost(b1, a1, inst) - removed;
+                    if(delta < best){ best = delta; ba = a; bb = b; breverse = true; }
+                }
+            }
+        }
+
+        int a = ba, b = bb, a1 = succ[a], b1 = succ[b];
+        int old = comp[b];
+        int curr = b;
+        do{
+            comp[curr] = comp[a];
+            curr = succ[curr];
+        }while(curr != b);
+        if(breverse){
+            reverse_cycle(succ, b);
+            succ[a] = b;
+            succ[b1] = a1;
+        }else{
+            succ[a] = b1;
+            succ[b] = a1;
+        }
+        print(inst, 'D', 3, "Patching: merged component %d, delta = %f", old, best);
+        ncomp--;
+    }
+}
+
+/**
+ * Patch cycles into a tour and refine it by 2-opt on candidate lists.
+ * No memory is allocated, so it can be called by CPLEX callbacks.
+ *
+ * @param inst general instance
+ * @param succ cycles, returned as a tour
+ * @param comp components, changed
+ * @param ncomp number of components
+ * @param t tour workspace
+ * @param q node queue workspace (empty)
+ * @return tour cost
+ */
+double patch_tour(instance *inst, int *succ, int *comp, int ncomp, tour *t, nodequeue *q){
+    patch(inst, succ, comp, ncomp);
+
+    succtotour(inst, succ, t);
+    for(int i = 0; i < inst->nnodes; i++)
+        push_node(q, i);
+    two_opt_local(inst, t, q, false);
+    tourtosucc(t, succ);
+
+    return cost_succ(inst, succ);
+}
+
+/**
+ * Add the tours of the elite pool (or inst->succ if there's no pool) as MIP starts, with a single
+ * CPXaddmipstarts() call. Only the tour edges are given, CPLEX completes the starts.
+ * Tours with edges out of a sparse model are skipped.
+ *
+ * @param inst general instance
+ */
+void add_mipstarts(instance *inst){
+    int n = inst->nnodes;
+    bool pool = (inst->elite != NULL && inst->elite->size > 0);
+    int ntours = pool ? inst->elite->size : 1;
+    int *beg = (int *) malloc(ntours * sizeof(int));
+    int *effort = (int *) malloc(ntours * sizeof(int));
+    int *index = (int *) malloc(ntours * n * sizeof(int));
+    double *value = (double *) malloc(ntours * n * sizeof(double));
+
+    int nstarts = 0, nnz = 0;
+    for(int s = 0; s < ntours; s++){
+        const int *succ = pool ? inst->elite->succ[s] : inst->succ;
+        bool complete = true;
+        for(int i = 0; i < n && complete; i++){
+            int k;
+            if(inst->edges != NULL)
+                k = edgeset_find(inst->edges, i, succ[i]);
+            else
+                k = inst->directed ? xpos_directed(i, succ[i], inst) : xpos_undirected(i, succ[i], inst);
+            index[nnz + i] = k;
+            value[nnz + i] = 1;
+            complete = (k >= 0);
+        }
+        if(!complete){
+            print(inst, 'D', 2, "MIP start %d skipped: edge out of the sparse model", s + 1);
+            continue;
+        }
+        beg[nstarts] = nnz;
+        effort[nstarts++] = CPX_MIPSTART_AUTO;
+        nnz += n;
+    }
+
+    if(nstarts > 0 && CPXaddmipstarts(inst->CPXenv, inst->CPXlp, nstarts, nnz, beg, index, value, effort, NULL))
+        print(inst, 'W', 1, "Can't add warm start");
+    print(inst, 'D', 1, "Added %d MIP starts", nstarts);
+
+    free(beg);
+    free(effort);
+    free(index);
+    free(value);
 }
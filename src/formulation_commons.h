@@ -10,6 +10,44 @@
 
 #include "utils.h"
 #include "distances.h"
+#include "heuristic_kopt.h"
+
+#define NAMELEN 32 // max length of CPLEX column and row names
+
+// ===== BATCHED MODEL CONSTRUCTION =====
+// columns collected in arrays and added with a single CPXnewcols()
+typedef struct{
+    int first;          // index of the first column of the batch
+    int n, cap;         // columns added so far and capacity
+    double *obj, *lb, *ub;
+    char *type;
+    char **name;        // NULL when names are not needed
+} colbatch;
+
+// rows collected in CSR form (beg, ind, val) and added with a single CPXaddrows()
+typedef struct{
+    int n, cap;         // rows added so far and capacity
+    int nnz, nzcap;     // nonzeros added so far and capacity
+    double *rhs;
+    char *sense;
+    int *beg, *ind;
+    double *val;
+    char **name;        // NULL when names are not needed
+} rowbatch;
+
+bool use_names(instance *inst);
+
+colbatch * new_colbatch(instance *inst, int count);
+
+int colbatch_add(colbatch *b, double obj, double lb, double ub, char type, const char *fmt, ...);
+
+void colbatch_submit(instance *inst, colbatch *b);
+
+rowbatch * new_rowbatch(instance *inst, int count, int nnz);
+
+int rowbatch_add(rowbatch *b, double rhs, char sense, int nnz, const int *ind, const double *val, const char *fmt, ...);
+
+void rowbatch_submit(instance *inst, rowbatch *b, bool lazy);
 
 // ===== DIRECTED GRAPH =====
 int xpos_directed(int i, int j, instance *inst);
@@ -30,4 +68,10 @@ void build_model_base_undirected(instance *inst);
 void get_solution_base_undirected(instance *inst);
 
 void findccomp(instance *inst, const double *xstar, int *ncomp, int *succ, int *comp);
+
+void patch(instance *inst, int *succ, int *comp, int ncomp);
+
+double patch_tour(instance *inst, int *succ, int *comp, int ncomp, tour *t, nodequeue *q);
+
+void add_mipstarts(instance *inst);
 #endif //TSP_OP2_FORMULATION_COMMONS_H
@@ -3,98 +3,666 @@
 //
 
 #include "formulation_cuts.h"
-#include "heuristic_greedy.h"
+#include "heuristics.h"
+#include "heuristic_greedyedge.h"
+#include "heuristic_kopt.h"
+#include "formulation_pricing.h"
+#include "unionfind.h"
+#include "candidates.h"
 
-static int CPXPUBLIC subtourcuts(CPXCALLBACKCONTEXTptr context, CPXLONG contextid, void *userhandle ){
-    instance *inst = (instance *) userhandle;
+/**
+ * (Re)allocate the workspace of a CPLEX thread: it's done when the thread starts,
+ * so the callbacks don't allocate memory (only Concorde's min-cut separation does).
+ *
+ * @param inst general instance
+ * @param t thread workspace (zeroed or already allocated)
+ */
+void alloc_workspace(instance *inst, cutsthread *t){
+    int n = inst->nnodes;
+    if(t->cap >= inst->ncols && t->xstar != NULL) return;
+
+    free_workspace(t);
+    t->cap = inst->ncols;
+    t->xstar = (double *) malloc(t->cap * sizeof(double));
+    t->x = (double *) malloc(t->cap * sizeof(double));
+    t->elist = (int *) malloc(2 * t->cap * sizeof(int));
+    t->index = (int *) malloc(t->cap * sizeof(int));
+    t->nodes = (int *) malloc(n * sizeof(int));
+    t->start = (int *) malloc((n + 1) * sizeof(int));
+    t->comp = (int *) malloc(n * sizeof(int));
+    for(int i = 0; i < n; i++) t->comp[i] = -1;
+    t->uf = new_unionfind(n);
+    t->succ = (int *) malloc(n * sizeof(int));
+    t->hcomp = (int *) malloc(n * sizeof(int));
+    t->adj = (int *) malloc(2 * n * sizeof(int));
+    t->supp = (suppedge *) malloc(t->cap * sizeof(suppedge));
+    t->tour = new_tour(n);
+    t->queue = new_nodequeue(n);
+}
+
+/**
+ * Indices of the columns of a subtour elimination constraint x(E(S)) <= |S| - 1.
+ *
+ * @param inst general instance
+ * @param t thread workspace
+ * @param nodes nodes of S
+ * @param size |S|
+ * @return number of columns, returned in t->index
+ */
+static int sec_index(instance *inst, cutsthread *t, const int *nodes, int size){
+    int nnz = 0;
+
+    // sparse model: only the edges in the model
+    if(inst->edges != NULL){
+        for(int a = 0; a < size; a++) t->comp[nodes[a]] = 1;
+        for(int k = 0; k < inst->ncols; k++)
+            if(t->comp[inst->edges->u[k]] == 1 && t->comp[inst->edges->v[k]] == 1)
+                t->index[nnz++] = k;
+        for(int a = 0; a < size; a++) t->comp[nodes[a]] = -1;
+        return nnz;
+    }
+
+    for(int a = 0; a < size; a++)
+        for(int b = a + 1; b < size; b++)
+            t->index[nnz++] = xpos_undirected(nodes[a], nodes[b], inst);
+    return nnz;
+}
+
+/**
+ * Group the nodes by union-find set.
+ *
+ * @param inst general instance
+ * @param t thread workspace: returns the nodes of the k-th set in t->nodes[t->start[k]...t->start[k + 1]]
+ * @return number of sets
+ */
+static int group_sets(instance *inst, cutsthread *t){
+    int n = inst->nnodes;
+    int nsets = 0;
+
+    // label sets 0..nsets-1 (t->comp is -1 everywhere between two calls)
+    for(int i = 0; i < n; i++){
+        int r = uf_find(t->uf, i);
+        if(t->comp[r] < 0) t->comp[r] = nsets++;
+    }
+    for(int k = 0; k <= nsets; k++) t->start[k] = 0;
+    for(int i = 0; i < n; i++) t->start[t->comp[uf_find(t->uf, i)] + 1]++;
+    for(int k = 0; k < nsets; k++) t->start[k + 1] += t->start[k];
+    for(int i = 0; i < n; i++){
+        int c = t->comp[uf_find(t->uf, i)];
+        t->nodes[t->start[c]++] = i;
+    }
+    for(int k = nsets; k > 0; k--) t->start[k] = t->start[k - 1];
+    t->start[0] = 0;
+
+    for(int i = 0; i < n; i++) t->comp[i] = -1;
+    return nsets;
+}
+
+/**
+ * Cycles of a set of fragments (paths or cycles): paths are closed on their endpoints.
+ *
+ * @param inst general instance
+ * @param t thread workspace: fragments in t->adj, returns cycles in t->succ and their labels in t->hcomp
+ * @return number of cycles
+ */
+static int fragment_cycles(instance *inst, cutsthread *t){
+    int n = inst->nnodes;
+    int ncomp = 0;
+    for(int i = 0; i < n; i++) t->hcomp[i] = -1;
+
+    // visit paths from an endpoint first, then cycles
+    for(int pass = 0; pass < 2; pass++)
+        for(int start = 0; start < n; start++){
+            if(t->hcomp[start] >= 0 || (pass == 0 && t->adj[2 * start + 1] != NONE)) continue;
+            ncomp++;
+            int curr = start;
+            while(true){
+                t->hcomp[curr] = ncomp;
+                int next = t->adj[2 * curr];
+                if(next == NONE || t->hcomp[next] >= 0) next = t->adj[2 * curr + 1];
+                if(next == NONE || t->hcomp[next] >= 0) break;
+                t->succ[curr] = next;
+                curr = next;
+            }
+            t->succ[curr] = start;
+        }
+    return ncomp;
+}
+
+/**
+ * Post the tour in t->succ to CPLEX if it beats the incumbent.
+ *
+ * @param context CPLEX callback context
+ * @param data callback data
+ * @param t thread workspace
+ * @param z tour cost
+ * @param incumbent incumbent objective value
+ */
+static void post_succ(CPXCALLBACKCONTEXTptr context, cutsdata *data, cutsthread *t, double z, double incumbent){
+    instance *inst = data->inst;
+
+    // full solution vector and its objective value
+    for(int k = 0; k < inst->ncols; k++){
+        t->index[k] = k;
+        t->x[k] = 0;
+    }
+    double objval = (data->obj == NULL) ? z : 0;
+    for(int i = 0; i < inst->nnodes; i++){
+        int k = (inst->edges != NULL) ? edgeset_find(inst->edges, i, t->succ[i])
+                                      : xpos_undirected(i, t->succ[i], inst);
+        if(k < 0 || k >= inst->ncols) return; // the tour uses an edge out of the sparse model
+        t->x[k] = 1;
+        if(data->obj != NULL) objval += data->obj[k];
+    }
+    if(objval >= incumbent - EPSILON) return;
+    if(CPXcallbackpostheuristicsoln(context, inst->ncols, t->index, t->x, objval, CPXCALLBACKSOLUTION_CHECKFEAS))
+        printerr(inst, "CPXcallbackpostheuristicsoln() error");
+    print(inst, 'D', 2, "Callback: posted heuristic tour of cost %f (objective %f, incumbent %f)", z, objval, incumbent);
+}
+
+/**
+ * Patch the fragments in t->adj into a tour, refine it by 2-opt and post it to CPLEX
+ * if it beats the incumbent (proximity search: if it's within the cutoff and closer to the reference tour).
+ *
+ * @param context CPLEX callback context
+ * @param data callback data
+ * @param t thread workspace
+ */
+static void post_tour(CPXCALLBACKCONTEXTptr context, cutsdata *data, cutsthread *t){
+    instance *inst = data->inst;
+    double incumbent = CPX_INFBOUND;
+    if(CPXcallbackgetinfodbl(context, CPXCALLBACKINFO_BEST_SOL, &incumbent))
+        printerr(inst, "CPXcallbackgetinfodbl() error");
+
+    int ncomp = fragment_cycles(inst, t);
+    double z = patch_tour(inst, t->succ, t->hcomp, ncomp, t->tour, t->queue);
+    if(data->obj == NULL ? z >= incumbent - EPSILON : z > data->cutoff) return;
+    post_succ(context, data, t, z, incumbent);
+}
+
+/**
+ * Candidate callback: reject integer solutions with subtours, adding a SEC for each connected component.
+ * Components are found by union-find on the support edges (x > 0.5); then they are patched
+ * into a tour which is posted as heuristic solution.
+ *
+ * @param context CPLEX callback context
+ * @param data callback data
+ * @param t thread workspace
+ * @return 0 (CPLEX error code)
+ */
+static int subtourcuts(CPXCALLBACKCONTEXTptr context, cutsdata *data, cutsthread *t){
+    instance *inst = data->inst;
     print(inst, 'D', 3, "Callback called");
 
     // retrieve xstar
-    double *xstar = (double*) malloc(inst->ncols * sizeof(double));
     double objval = CPX_INFBOUND;
-    if(CPXcallbackgetcandidatepoint(context, xstar, 0, inst->ncols - 1, &objval))
+    if(CPXcallbackgetcandidatepoint(context, t->xstar, 0, inst->ncols - 1, &objval))
         printerr(inst, "CPXcallbackgetcandidatepoint error");
 
     // find connected components
-    int ncomp;
-    int *succ = (int *) malloc(inst->nnodes * sizeof(int));
-    int *comp = (int *) malloc(inst->nnodes * sizeof(int));
-    findccomp(inst, xstar, &ncomp, succ, comp);
+    uf_reset(t->uf);
+    if(inst->edges != NULL){
+        for(int k = 0; k < inst->ncols; k++)
+            if(t->xstar[k] > 0.5) uf_union(t->uf, inst->edges->u[k], inst->edges->v[k]);
+    }else{
+        int k = 0;
+        for(int i = 0; i < inst->nnodes; i++)
+            for(int j = i + 1; j < inst->nnodes; j++, k++)
+                if(t->xstar[k] > 0.5) uf_union(t->uf, i, j);
+    }
 
     // skip if solution found!
-    if(ncomp == 1)
+    if(t->uf->nsets == 1)
         return 0;
 
-    double *value = (double *) malloc(inst->ncols * sizeof(double));
-    int *index = (int *) malloc(inst->ncols * sizeof(int));
-    // initialize value vector that doesn't change!
-    for(int i = 0; i < inst->ncols; i++) value[i] = 1;
+    int ncomp = group_sets(inst, t);
     char sense = 'L';
     int izero = 0;
+    for(int c = 0; c < ncomp; c++){
+        int csize = t->start[c + 1] - t->start[c]; // component size
+        double rhs = csize - 1;
+        int nnz = sec_index(inst, t, t->nodes + t->start[c], csize);
+        if(CPXcallbackrejectcandidate(context, 1, nnz, &rhs, &sense, &izero, t->index, data->value))
+            printerr(inst, "Can't add cut!");
 
-    for(int curr_comp = 1; curr_comp <= ncomp; curr_comp++){
-        int csize = 0; // component size
-        int nedges = 0; // all possible edges in the component
+        print(inst, 'D', 3,"Added cut for component %d of size %d", c + 1, csize);
+    }
 
-        for(int i = 0; i < inst->nnodes; i++){
-            if(comp[i] != curr_comp) continue;
-            csize++;
-            for(int j = i + 1; j < inst->nnodes; j++){
-                if(comp[j] != curr_comp) continue;
+    // patch the subtours
+    for(int i = 0; i < 2 * inst->nnodes; i++) t->adj[i] = NONE;
+    uf_reset(t->uf);
+    if(inst->edges != NULL){
+        for(int k = 0; k < inst->ncols; k++)
+            if(t->xstar[k] > 0.5) add_fragment_edge(t->adj, t->uf, inst->edges->u[k], inst->edges->v[k]);
+    }else{
+        int k = 0;
+        for(int i = 0; i < inst->nnodes; i++)
+            for(int j = i + 1; j < inst->nnodes; j++, k++)
+                if(t->xstar[k] > 0.5) add_fragment_edge(t->adj, t->uf, i, j);
+    }
+    post_tour(context, data, t);
+    return 0;
+}
+
+// data passed to the Concorde cut callback
+typedef struct{
+    cutsdata *data;
+    cutsthread *t;
+    CPXCALLBACKCONTEXTptr context;
+    int ncuts;          // cuts added so far
+} cutparams;
 
-                // here `i` and `j` must belong to `curr_comp`
-                if(nedges >= inst->ncols) printerr(inst, "Illegal state: must be tot_edges < tot_cols!");
-                // save index
-                index[nedges++] = xpos_undirected(i, j, inst);
+/**
+ * Add the SEC on the node set S as a (purgeable) user cut.
+ *
+ * @param param cut parameters
+ * @param size |S|
+ * @param nodes nodes of S
+ */
+static void add_user_sec(void *param, int size, const int *nodes){
+    cutparams *p = (cutparams *) param;
+    instance *inst = p->data->inst;
+    if(size < 2 || size > inst->nnodes - 2 || p->ncuts >= RELAX_MAXCUTS) return;
+
+    int nnz = sec_index(inst, p->t, nodes, size);
+    double rhs = size - 1;
+    char sense = 'L';
+    int izero = 0;
+    int purgeable = CPX_USECUT_FILTER;
+    int local = 0;
+    if(CPXcallbackaddusercuts(p->context, 1, nnz, &rhs, &sense, &izero, p->t->index, p->data->value,
+                              &purgeable, &local))
+        printerr(inst, "CPXcallbackaddusercuts() error");
+    p->ncuts++;
+}
+
+// SEC handler passed through Concorde
+typedef struct{
+    secfunc add;
+    void *param;
+} secparams;
+
+// called by CCcut_violated_cuts() for each cut with x(delta(S)) < cutoff
+static int violated_cut(double cutval, int cutcount, int *cut, void *param){
+    secparams *p = (secparams *) param;
+    p->add(p->param, cutcount, cut);
+    return 0;
+}
+
+/**
+ * Separate SECs on a fractional solution: one for each connected component of the support graph or,
+ * if it's connected, those found by Concorde's min-cut routines.
+ * The components are found by the workspace union-find, so only the min-cut separation allocates memory.
+ *
+ * @param inst general instance
+ * @param t workspace: fractional solution in t->xstar, returns the support graph in t->elist, t->x
+ * @param add called with the nodes of each violated SEC
+ * @param param passed to add
+ * @param ncomp returned number of connected components
+ * @return number of support edges
+ */
+int separate_sec(instance *inst, cutsthread *t, secfunc add, void *param, int *ncomp){
+    const double *xstar = t->xstar;
+    int *elist = t->elist;
+    double *x = t->x;
+
+    // support graph in Concorde format
+    int ecount = 0;
+    if(inst->edges != NULL){
+        for(int k = 0; k < inst->ncols; k++){
+            if(xstar[k] <= RELAX_EPS) continue;
+            elist[2 * ecount] = inst->edges->u[k];
+            elist[2 * ecount + 1] = inst->edges->v[k];
+            x[ecount++] = xstar[k];
+        }
+    }else{
+        int k = 0;
+        for(int i = 0; i < inst->nnodes; i++)
+            for(int j = i + 1; j < inst->nnodes; j++, k++){
+                if(xstar[k] <= RELAX_EPS) continue;
+                elist[2 * ecount] = i;
+                elist[2 * ecount + 1] = j;
+                x[ecount++] = xstar[k];
             }
+    }
+
+    // connected components
+    uf_reset(t->uf);
+    for(int k = 0; k < ecount; k++)
+        uf_union(t->uf, elist[2 * k], elist[2 * k + 1]);
+    *ncomp = t->uf->nsets;
+
+    secparams p = {add, param};
+    if(*ncomp > 1){
+        // a SEC for each component
+        group_sets(inst, t);
+        for(int c = 0; c < *ncomp; c++)
+            add(param, t->start[c + 1] - t->start[c], t->nodes + t->start[c]);
+    }else if(CCcut_violated_cuts(inst->nnodes, ecount, elist, x, 2.0 - RELAX_EPS, violated_cut, &p))
+        printerr(inst, "CCcut_violated_cuts() error");
+    return ecount;
+}
+
+// by decreasing x, then by increasing cost
+static int compare_supp(const void *a, const void *b){
+    const suppedge *e = (const suppedge *) a, *f = (const suppedge *) b;
+    if(e->x != f->x) return (e->x < f->x) ? 1 : -1;
+    return (e->c > f->c) - (e->c < f->c);
+}
+
+/**
+ * Rounding heuristic: greedy edge on the support edges of the fractional solution sorted by decreasing x,
+ * then the fragments are patched into a tour and posted.
+ *
+ * @param context CPLEX callback context
+ * @param data callback data
+ * @param t thread workspace: support graph in t->elist, t->x
+ * @param ecount number of support edges
+ */
+static void round_relaxation(CPXCALLBACKCONTEXTptr context, cutsdata *data, cutsthread *t, int ecount){
+    instance *inst = data->inst;
+    for(int k = 0; k < ecount; k++){
+        int u = t->elist[2 * k], v = t->elist[2 * k + 1];
+        t->supp[k] = (suppedge) {t->x[k], cost(u, v, inst), u, v};
+    }
+    qsort(t->supp, ecount, sizeof(suppedge), compare_supp);
+
+    for(int i = 0; i < 2 * inst->nnodes; i++) t->adj[i] = NONE;
+    uf_reset(t->uf);
+    for(int k = 0, accepted = 0; k < ecount && accepted < inst->nnodes - 1; k++)
+        if(add_fragment_edge(t->adj, t->uf, t->supp[k].u, t->supp[k].v))
+            accepted++;
+    post_tour(context, data, t);
+}
+
+/**
+ * Separate SECs on the fractional solution of the node relaxation:
+ * one for each connected component of the support graph or, if it's connected,
+ * those found by Concorde's min-cut routines.
+ * The number of rounds at the same node and the number of cuts per round are limited.
+ * When no cut is found, x* is rounded to a tour at the root and every RELAX_HEURFREQ nodes.
+ *
+ * @param context CPLEX callback context
+ * @param data callback data
+ * @param t thread workspace
+ * @return 0 (CPLEX error code)
+ */
+static int relaxcuts(CPXCALLBACKCONTEXTptr context, cutsdata *data, cutsthread *t){
+    instance *inst = data->inst;
+
+    // rate limits
+    CPXLONG node, depth;
+    CPXcallbackgetinfolong(context, CPXCALLBACKINFO_NODEUID, &node);
+    CPXcallbackgetinfolong(context, CPXCALLBACKINFO_NODEDEPTH, &depth);
+    if(t->node != node){
+        t->node = node;
+        t->rounds = 0;
+    }
+    if(t->rounds++ >= ((depth == 0) ? RELAX_ROOTROUNDS : RELAX_NODEROUNDS))
+        return 0;
+
+    // retrieve fractional xstar
+    double objval = CPX_INFBOUND;
+    if(CPXcallbackgetrelaxationpoint(context, t->xstar, 0, inst->ncols - 1, &objval))
+        printerr(inst, "CPXcallbackgetrelaxationpoint() error");
+
+    cutparams p = {data, t, context, 0};
+    int ncomp;
+    int ecount = separate_sec(inst, t, add_user_sec, &p, &ncomp);
+    print(inst, 'D', 3, "Relaxation callback: %d user cuts (%d components)", p.ncuts, ncomp);
+
+    if(p.ncuts == 0 && (depth == 0 || node % RELAX_HEURFREQ == 0))
+        round_relaxation(context, data, t, ecount);
+    return 0;
+}
+
+// add the edge [i, j] to the adjacency lists of a tour
+static void link_nodes(int *adj, int i, int j){
+    adj[2 * i + (adj[2 * i] != NONE)] = j;
+    adj[2 * j + (adj[2 * j] != NONE)] = i;
+}
+
+/**
+ * Portfolio: post the shared tour if it changed since the last time it was posted.
+ * Only one thread posts each version.
+ *
+ * @param context CPLEX callback context
+ * @param data callback data
+ * @param t thread workspace
+ */
+static void inject_shared(CPXCALLBACKCONTEXTptr context, cutsdata *data, cutsthread *t){
+    sharedtour *s = data->shared;
+    long version = atomic_load(&s->version);
+    long seen = atomic_load(&data->injected);
+    if(version == seen || !atomic_compare_exchange_strong(&data->injected, &seen, version)) return;
+
+    double incumbent = CPX_INFBOUND;
+    if(CPXcallbackgetinfodbl(context, CPXCALLBACKINFO_BEST_SOL, &incumbent))
+        printerr(data->inst, "CPXcallbackgetinfodbl() error");
+    double z;
+    shared_get(s, t->succ, &z);
+    post_succ(context, data, t, z, incumbent);
+}
+
+/**
+ * Portfolio: share the CPLEX incumbent with the heuristics when it's better than the shared tour,
+ * then post the shared tour if the heuristics improved it.
+ *
+ * @param context CPLEX callback context
+ * @param data callback data
+ * @param t thread workspace
+ * @return 0 (CPLEX error code)
+ */
+static int progress(CPXCALLBACKCONTEXTptr context, cutsdata *data, cutsthread *t){
+    instance *inst = data->inst;
+    int n = inst->nnodes;
+    double incumbent = CPX_INFBOUND;
+    if(CPXcallbackgetinfodbl(context, CPXCALLBACKINFO_BEST_SOL, &incumbent))
+        printerr(inst, "CPXcallbackgetinfodbl() error");
+
+    if(incumbent < atomic_load(&data->shared->z) - EPSILON &&
+       !CPXcallbackgetincumbent(context, t->xstar, 0, inst->ncols - 1, &incumbent)){
+        // successors of the incumbent (a tour)
+        for(int i = 0; i < 2 * n; i++) t->adj[i] = NONE;
+        if(inst->edges != NULL){
+            for(int k = 0; k < inst->ncols; k++)
+                if(t->xstar[k] > 0.5) link_nodes(t->adj, inst->edges->u[k], inst->edges->v[k]);
+        }else{
+            for(int i = 0, k = 0; i < n; i++)
+                for(int j = i + 1; j < n; j++, k++)
+                    if(t->xstar[k] > 0.5) link_nodes(t->adj, i, j);
         }
-        double rhs = csize - 1;
-        int nnz = nedges;
-        if(CPXcallbackrejectcandidate(context, 1, nnz, &rhs, &sense, &izero, index, value))
-            printerr(inst, "Can't add cut!");
+        for(int prev = t->adj[1], curr = 0, k = 0; k < n; k++){
+            int next = (t->adj[2 * curr] != prev) ? t->adj[2 * curr] : t->adj[2 * curr + 1];
+            t->succ[curr] = next;
+            prev = curr;
+            curr = next;
+        }
+        if(shared_put(data->shared, t->succ, incumbent))
+            print(inst, 'D', 1, "Portfolio: CPLEX incumbent %f shared", incumbent);
+    }
+
+    inject_shared(context, data, t);
+    return 0;
+}
+
+static int CPXPUBLIC cuts_callback(CPXCALLBACKCONTEXTptr context, CPXLONG contextid, void *userhandle){
+    cutsdata *data = (cutsdata *) userhandle;
+    CPXINT thread;
+    if(CPXcallbackgetinfoint(context, CPXCALLBACKINFO_THREADID, &thread) || thread >= data->nthreads)
+        printerr(data->inst, "Callback: bad thread id");
+    cutsthread *t = &data->thread[thread];
 
-        print(inst, 'D', 3,"Added cut for component %d of size %d", curr_comp, csize);
+    switch(contextid){
+        case CPX_CALLBACKCONTEXT_THREAD_UP:
+            t->node = -1;
+            t->rounds = 0;
+            alloc_workspace(data->inst, t);
+            return 0;
+        case CPX_CALLBACKCONTEXT_THREAD_DOWN:
+            free_workspace(t);
+            return 0;
+        case CPX_CALLBACKCONTEXT_CANDIDATE:
+            alloc_workspace(data->inst, t); // no-op unless THREAD_UP was skipped
+            return subtourcuts(context, data, t);
+        case CPX_CALLBACKCONTEXT_RELAXATION:
+            alloc_workspace(data->inst, t);
+            if(data->shared != NULL) inject_shared(context, data, t);
+            return relaxcuts(context, data, t);
+        case CPX_CALLBACKCONTEXT_GLOBAL_PROGRESS:
+            alloc_workspace(data->inst, t);
+            return progress(context, data, t);
+        default:
+            return 0;
     }
+}
+
+/**
+ * Heuristic tour for the sparse model: greedy edge refined by 2-opt on candidate lists.
+ *
+ * @param inst general instance
+ */
+static void sparse_tour(instance *inst){
+    greedy_edge(inst);
+
+    tour *t = new_tour(inst->nnodes);
+    succtotour(inst, inst->succ, t);
+    nodequeue *q = new_nodequeue(inst->nnodes);
+    for(int i = 0; i < inst->nnodes; i++)
+        push_node(q, i);
+    two_opt_local(inst, t, q, false);
+    tourtosucc(t, inst->succ);
+    inst->zbest = cost_succ(inst, inst->succ);
 
-    free(xstar);
-    free(succ);
-    free(comp);
-    free(value);
-    free(index);
+    free_nodequeue(q);
+    free_tour(t);
 }
 
 void build_model_cuts(instance *inst){
+    // heuristic tour: warm start and (sparse model) edges which guarantee feasibility
+    bool warm = (inst->formulation == CUTS2) || (inst->formulation == PORTFOLIO) ||
+                (inst->formulation == CUTS1 && inst->ws_cons != CHLAST);
+    if(warm)
+        warm_start(inst, GREEDY);
+    else if(inst->sparse)
+        sparse_tour(inst);
+    if(inst->sparse){
+        sparse_edges(inst, inst->succ);
+        for(int s = 0; inst->elite != NULL && s < inst->elite->size; s++)
+            for(int i = 0; i < inst->nnodes; i++)
+                edgeset_add(inst->edges, i, inst->elite->succ[s][i]);
+    }
+    inst->directed = false;
+
     // write base model
     build_model_base_undirected(inst);
 
     inst->ncols = CPXgetnumcols(inst->CPXenv, inst->CPXlp);
 
-    // install callback
-    CPXLONG contextid = CPX_CALLBACKCONTEXT_CANDIDATE;
-    if(CPXcallbacksetfunc(inst->CPXenv, inst->CPXlp, contextid, subtourcuts, inst))
-        printerr(inst,"CPXcallbacksetfunc() error");
+    install_cuts_callback(inst, ncores());
 
     // put a warm start
-    if(inst->formulation == CUTS2) {
-        double *xbest = calloc(inst->ncols, sizeof(double));
-        greedy(inst, inst->time_limit / 10);
-        inst->directed = false;
-        for (int i = 0; i < inst->nnodes; i++) {
-            for (int j = 0; j < inst->nnodes; j++) {
-                if (inst->xbest[xpos_directed(i, j, inst)] > 0.5)
-                    xbest[xpos_undirected(i, j, inst)] = 1;
-            }
-        }
-        int varindices[inst->ncols];
-        for(int i = 0; i < inst->ncols; i++) varindices[i] = i;
-        int beg[] = {0};
-        if(CPXaddmipstarts(inst->CPXenv, inst->CPXlp, 1, inst->ncols, beg, varindices, xbest,
-                        CPX_MIPSTART_AUTO, NULL))
-            print(inst, 'W', 1,"Can't add warm start");
+    if(warm || inst->sparse) {
+        add_mipstarts(inst);
         print(inst, 'I', 1, "Heuristic solution cost: %f", inst->zbest);
     }
 }
 
+/**
+ * Install the cuts callback on the model: one workspace for each CPLEX thread, allocated when the thread starts.
+ *
+ * @param inst general instance (inst->ncols must be set)
+ * @param nthreads number of CPLEX threads
+ */
+void install_cuts_callback(instance *inst, int nthreads){
+    // candidate lists used by the callback heuristics: computed here, then read only
+    candidates(inst);
+
+    free_cutsdata(inst->cbdata);
+    cutsdata *data = (cutsdata *) malloc(sizeof(cutsdata));
+    data->inst = inst;
+    data->nthreads = nthreads;
+    data->thread = (cutsthread *) calloc(data->nthreads, sizeof(cutsthread));
+    data->value = (double *) malloc(inst->ncols * sizeof(double));
+    for(int i = 0; i < inst->ncols; i++) data->value[i] = 1;
+    data->obj = NULL;
+    data->cutoff = CPX_INFBOUND;
+    data->shared = NULL;
+    atomic_init(&data->injected, 0);
+    inst->cbdata = data;
+    CPXsetintparam(inst->CPXenv, CPXPARAM_Threads, data->nthreads);
+    CPXLONG contextid = CPX_CALLBACKCONTEXT_CANDIDATE | CPX_CALLBACKCONTEXT_RELAXATION |
+                        CPX_CALLBACKCONTEXT_THREAD_UP | CPX_CALLBACKCONTEXT_THREAD_DOWN;
+    if(CPXcallbacksetfunc(inst->CPXenv, inst->CPXlp, contextid, cuts_callback, data))
+        printerr(inst,"CPXcallbacksetfunc() error");
+}
+
+/**
+ * Share the incumbent with concurrent heuristics (portfolio): the callback also listens to the global
+ * progress of the search, where CPLEX incumbents are copied to the shared tour and the shared tour,
+ * if improved by the heuristics, is posted to CPLEX.
+ *
+ * @param inst general instance (callback already installed)
+ * @param s shared tour
+ */
+void share_incumbent(instance *inst, sharedtour *s){
+    cutsdata *data = inst->cbdata;
+    data->shared = s;
+    atomic_store(&data->injected, atomic_load(&s->version));
+    CPXLONG contextid = CPX_CALLBACKCONTEXT_CANDIDATE | CPX_CALLBACKCONTEXT_RELAXATION |
+                        CPX_CALLBACKCONTEXT_THREAD_UP | CPX_CALLBACKCONTEXT_THREAD_DOWN |
+                        CPX_CALLBACKCONTEXT_GLOBAL_PROGRESS;
+    if(CPXcallbacksetfunc(inst->CPXenv, inst->CPXlp, contextid, cuts_callback, data))
+        printerr(inst,"CPXcallbacksetfunc() error");
+}
+
+/**
+ * Resize the callback data after columns have been added to the model (sparse models):
+ * thread workspaces are resized when the threads start again.
+ *
+ * @param inst general instance
+ */
+void resize_cutsdata(instance *inst){
+    cutsdata *data = inst->cbdata;
+    if(data == NULL) return;
+    data->value = (double *) realloc(data->value, inst->ncols * sizeof(double));
+    for(int i = 0; i < inst->ncols; i++) data->value[i] = 1;
+}
+
+void free_workspace(cutsthread *t){
+    free(t->xstar);
+    free(t->x);
+    free(t->elist);
+    free(t->index);
+    free(t->nodes);
+    free(t->start);
+    free(t->comp);
+    if(t->uf != NULL) free_unionfind(t->uf);
+    free(t->succ);
+    free(t->hcomp);
+    free(t->adj);
+    free(t->supp);
+    if(t->tour != NULL) free_tour(t->tour);
+    if(t->queue != NULL) free_nodequeue(t->queue);
+    t->xstar = t->x = NULL;
+    t->elist = t->index = t->nodes = t->start = t->comp = NULL;
+    t->succ = t->hcomp = t->adj = NULL;
+    t->supp = NULL;
+    t->uf = NULL;
+    t->tour = NULL;
+    t->queue = NULL;
+    t->cap = 0;
+}
+
+void free_cutsdata(cutsdata *data){
+    if(data == NULL) return;
+    for(int i = 0; i < data->nthreads; i++)
+        free_workspace(&data->thread[i]);
+    free(data->thread);
+    free(data->value);
+    free(data);
+}
+
 void get_solution_cuts(instance *inst){
     CPXgetobjval(inst->CPXenv, inst->CPXlp, &inst->zstar);
     get_solution_base_undirected(inst);
@@ -8,8 +8,75 @@
 #ifndef TSP_OP2_FORMULATION_CUTS_H
 #define TSP_OP2_FORMULATION_CUTS_H
 
+#include <concorde.h>
+
+#include "unionfind.h"
+
+#define RELAX_EPS 1e-6          // fractional SEC violation tolerance
+#define RELAX_ROOTROUNDS 100    // max separation rounds at the root node
+#define RELAX_NODEROUNDS 2      // max separation rounds at the other nodes
+#define RELAX_MAXCUTS 100       // max user cuts per round
+#define RELAX_HEURFREQ 10       // rounding heuristic at the root and every RELAX_HEURFREQ nodes
+
+// support edge of a fractional solution (rounding heuristic)
+typedef struct{
+    double x, c;        // value and cost
+    int u, v;
+} suppedge;
+
+// callback state and workspace of a CPLEX thread
+typedef struct{
+    long node;          // unique id of the last node seen
+    int rounds;         // separation rounds at that node
+    int cap;            // number of columns the workspace is sized for
+    double *xstar;      // CPLEX solution
+    double *x;          // support edge values (Concorde format)
+    int *elist;         // support edges (Concorde format)
+    int *index;         // column indices of a SEC
+    int *nodes;         // nodes grouped by component...
+    int *start;         // ...and first position of each component
+    int *comp;          // node labels, -1 between two calls
+    unionfind *uf;
+    // heuristic tours
+    int *succ;          // patched cycles
+    int *hcomp;         // components of the cycles
+    int *adj;           // adjacency lists of the fragments (2 per node)
+    suppedge *supp;     // support edges sorted by decreasing x
+    tour *tour;
+    nodequeue *queue;
+} cutsthread;
+
+// called by separate_sec() for each violated SEC x(E(S)) <= |S| - 1
+typedef void (*secfunc)(void *param, int size, const int *nodes);
+
+// callback data (passed as user handle)
+typedef struct cutsdata{
+    instance *inst;
+    int nthreads;
+    cutsthread *thread; // indexed by CPLEX thread id
+    double *value;      // all ones: SEC coefficients (read only)
+    const double *obj;  // objective coefficients when they aren't the edge costs (proximity search), or NULL
+    double cutoff;      // max cost of a posted tour when obj != NULL
+    sharedtour *shared; // tour shared with concurrent heuristics (portfolio), or NULL
+    _Atomic long injected; // last version of the shared tour posted to CPLEX
+} cutsdata;
+
 void build_model_cuts(instance *inst);
 
+void install_cuts_callback(instance *inst, int nthreads);
+
+void share_incumbent(instance *inst, sharedtour *s);
+
+int separate_sec(instance *inst, cutsthread *t, secfunc add, void *param, int *ncomp);
+
+void resize_cutsdata(instance *inst);
+
+void alloc_workspace(instance *inst, cutsthread *t);
+
+void free_workspace(cutsthread *t);
+
+void free_cutsdata(cutsdata *data);
+
 void get_solution_cuts(instance *inst);
 
 #endif //TSP_OP2_FORMULATION_CUTS_H
@@ -9,10 +9,10 @@
 //
 
 #include <sys/time.h>
+#include <pthread.h>
 #include "formulation_sfixing.h"
 #include "plot.h"
 #include "heuristics.h"
-#include "heuristic_greedy.h"
 
 void build_model_hfixing(instance *inst){
     build_model_cuts(inst);
@@ -31,40 +31,54 @@ double lin_func(double x, double m, double q){
     return y;
 }
 
-void fix_edges(instance *inst, double m, double q){
-    // if(perc < 0 || perc > 100) printerr(inst, "Cannot use perc = %d", perc);
-    if(inst->xbest == NULL) printerr(inst, "xbest must be not null!");
-
-    double *bd = calloc(inst->ncols, sizeof(double));
-
-    int *indices = calloc(inst->ncols, sizeof(int));
-    for(int i = 0; i < inst->ncols; i++) indices[i] = i;
-
-    char *lu = calloc(inst->ncols, sizeof(char));
-    for(int i = 0; i < inst->ncols; i++) lu[i] = 'L';
+/**
+ * Hard fix the edges of a reference solution: each one is fixed (lower bound 1) with probability
+ * lin_func(cost) percent, all the others are released. If an LP solution is given, only the edges
+ * at 1 in both solutions can be fixed (RINS).
+ * Only the bounds of the edges whose status changes are updated, i.e. at most 2 * nnodes.
+ *
+ * @param inst general instance
+ * @param xbest reference solution
+ * @param m slope of the fixing probability
+ * @param q intercept of the fixing probability
+ * @param fixed current status of the columns, updated
+ * @param xlp LP solution (can be NULL)
+ * @return number of fixed edges
+ */
+int fix_edges(instance *inst, const double *xbest, double m, double q, bool *fixed, const double *xlp){
+    int n = inst->nnodes;
+    int *indices = (int *) malloc(2 * n * sizeof(int));
+    char *lu = (char *) malloc(2 * n * sizeof(char));
+    double *bd = (double *) malloc(2 * n * sizeof(double));
 
     // choose edges
-    int counter = 0;
-    for(int i = 0; i < inst->nnodes; i++)
-        for(int j = i + 1; j < inst->nnodes; j++){
-            int k = xpos_undirected(i, j, inst);
-            double perc = lin_func(cost(i, j, inst), m, q);
-            if(inst->xbest[k] > 0.5) // if previously selected
-                if((bd[k] = (uprob(perc) ? 1 : 0))) { // put to 1 with 90% probability
-                    print(inst, 'D', 3, "Edge x(%d, %d) fixed", i, j);
-                    counter++;
-                }
+    int counter = 0, nchg = 0;
+    for(int i = 0, k = 0; i < n; i++)
+        for(int j = i + 1; j < n; j++, k++){
+            // fix previously selected edges with the given probability
+            bool fix = (xbest[k] > 0.5) && (xlp == NULL || xlp[k] > 1 - RELAX_EPS) &&
+                       uprob(lin_func(cost(i, j, inst), m, q));
+            if(fix){
+                print(inst, 'D', 3, "Edge x(%d, %d) fixed", i, j);
+                counter++;
+            }
+            if(fix == fixed[k]) continue;
+            fixed[k] = fix;
+            indices[nchg] = k;
+            lu[nchg] = 'L';
+            bd[nchg++] = fix ? 1 : 0;
         }
-    print(inst, 'D', 1, "fixed %d edges", counter);
+    print(inst, 'D', 1, "fixed %d edges (%d bounds changed)", counter, nchg);
 
     // change lower bounds
-    int status = CPXchgbds(inst->CPXenv, inst->CPXlp, inst->ncols, indices, lu, bd);
+    int status = (nchg > 0) ? CPXchgbds(inst->CPXenv, inst->CPXlp, nchg, indices, lu, bd) : 0;
     if(status)
         print(inst, 'D', 1, "Change bound error %d", status);
 
-    free(bd);
     free(indices);
     free(lu);
+    free(bd);
+    return counter;
 }
 
 void find_min_max(instance *inst, double *min, double *max){
@@ -118,23 +132,19 @@ void solve_hfixing(instance *inst){
 
     bool init = true;
 
-    if(inst->formulation == HFIXING4 || inst->formulation == HFIXING5) {
+    // current fixing status of the columns
+    bool *fixed = (bool *) calloc(inst->ncols, sizeof(bool));
+
+    // heuristic warm start (--warm-start chain or greedy)
+    if(inst->formulation == HFIXING4 || inst->formulation == HFIXING5 || inst->ws_cons != CHLAST) {
         init = false;
-        free(inst->xbest);
-        if(inst->formulation == HFIXING5)
-            inst->cons_heuristic = GREEDYGRASP;
-        greedy(inst, inst->time_limit/10);
+        warm_start(inst, (inst->formulation == HFIXING5) ? GREEDYGRASP : GREEDY);
         inst->directed = false;
-        for(int i = 0; i < inst->nnodes; i++){
-            for(int j = 0; j < inst->nnodes; j++){
-                if(inst->xbest[xpos_directed(i,j,inst)] > 0.5)
-                    xbest[xpos_undirected(i,j,inst)] = 1;
-            }
-        }
         free(inst->xbest);
-        inst->xbest = xbest;
-        xbest = (double *) calloc(inst->ncols, sizeof(double));
-        CPXsetlongparam(inst->CPXenv, CPXPARAM_MIP_Limits_Solutions,2);
+        inst->xbest = succtox(inst, inst->succ, false);
+        add_mipstarts(inst);
+        CPXsetlongparam(inst->CPXenv, CPXPARAM_MIP_Limits_Solutions,
+                        (inst->formulation == HFIXING1)?9223372036800000000L:2);
         //plot(inst, inst->xbest);
     }
 
@@ -156,7 +166,7 @@ void solve_hfixing(instance *inst){
                 CPXsetdblparam(inst->CPXenv, CPXPARAM_TimeLimit, left);
 
             // add local branching constraints
-            fix_edges(inst, m, q);
+            fix_edges(inst, inst->xbest, m, q, fixed, NULL);
 
             // add warm start
             CPXaddmipstarts(inst->CPXenv, inst->CPXlp, 1, inst->ncols, beg, varindices, inst->xbest,
@@ -209,10 +219,155 @@ void solve_hfixing(instance *inst){
         }
     }
     free(xbest);
+    free(fixed);
 
     // copy solution
     inst->xstar = (double *) calloc(inst->ncols, sizeof(double)); // TODO that's not "xstar"
     memcpy(inst->xstar, inst->xbest, inst->ncols * sizeof(double));
 
     inst->zstar = inst->zbest;
-}
\ No newline at end of file
+}
+
+// sub-MIP of the hard-fixing portfolio
+typedef struct{
+    instance *inst;     // model: the first worker uses the main one, the others a copy with their own environment
+    instance copy;
+    double rate;        // fixing probability (percent)
+    bool *fixed;        // current fixing status of the columns
+    double *x;          // sub-MIP solution
+    double z;           // sub-MIP solution cost
+    bool found;
+    pthread_t thread;
+} hfworker;
+
+static void * hfworker_run(void *arg){
+    hfworker *w = (hfworker *) arg;
+    instance *inst = w->inst;
+    w->found = !CPXmipopt(inst->CPXenv, inst->CPXlp) &&
+               !CPXgetx(inst->CPXenv, inst->CPXlp, w->x, 0, inst->ncols - 1) &&
+               !CPXgetobjval(inst->CPXenv, inst->CPXlp, &w->z);
+    return NULL;
+}
+
+/**
+ * Hard-fixing portfolio: at each round HFIX_WORKERS sub-MIPs run concurrently, each one with its own
+ * CPLEX environment, thread budget, fixing rate and random seed. They all start from the best tour found
+ * so far, which is updated at the end of the round.
+ * CPLEX parameters are set per environment, so the workers build their own copy of the model
+ * instead of cloning it.
+ *
+ * @param inst general instance (model built by build_model_hfixing())
+ */
+void solve_hfixing_portfolio(instance *inst){
+    double timelim = inst->time_limit / 20;
+    int nworkers = (ncores() < HFIX_WORKERS) ? ncores() : HFIX_WORKERS;
+    int nthreads = ncores() / nworkers;
+
+    // starting tour
+    warm_start(inst, GREEDYGRASP);
+    inst->directed = false;
+    free(inst->xbest);
+    inst->xbest = succtox(inst, inst->succ, false);
+
+    // workers
+    hfworker *workers = (hfworker *) calloc(nworkers, sizeof(hfworker));
+    install_cuts_callback(inst, nthreads);
+    for(int p = 0; p < nworkers; p++){
+        hfworker *w = &workers[p];
+        if(p == 0)
+            w->inst = inst;
+        else{
+            // shallow copy: points, candidates and tours are shared (read only)
+            w->copy = *inst;
+            w->inst = &w->copy;
+            w->copy.cbdata = NULL;
+            w->copy.elite = NULL;
+            int err;
+            w->copy.CPXenv = CPXopenCPLEX(&err);
+            if(err) printerr(inst, "Can't create CPLEX environment of worker %d", p);
+            w->copy.CPXlp = CPXcreateprob(w->copy.CPXenv, &err, "TSP");
+            if(err) printerr(inst, "Can't create LP problem of worker %d", p);
+            CPXsetdblparam(w->copy.CPXenv, CPXPARAM_MIP_Limits_TreeMemory, inst->mem_limit);
+            build_model_base_undirected(w->inst);
+            install_cuts_callback(w->inst, nthreads);
+        }
+        w->rate = (nworkers > 1) ? HFIX_RATEMAX - p * (HFIX_RATEMAX - HFIX_RATEMIN) / (nworkers - 1) : HFIX_RATEMAX;
+        w->fixed = (bool *) calloc(inst->ncols, sizeof(bool));
+        w->x = (double *) malloc(inst->ncols * sizeof(double));
+    }
+    print(inst, 'I', 1, "Hard-fixing portfolio: %d workers, %d threads each", nworkers, nthreads);
+
+    tourpool *elite = inst->elite;
+    int *comp = (int *) malloc(inst->nnodes * sizeof(int));
+    struct timeval now;
+    for(int round = 0; ; round++){
+        // check time limit
+        gettimeofday(&now, NULL);
+        double elapsed = (double) (now.tv_sec - inst->tstart.tv_sec);
+        if(elapsed >= inst->time_limit) {
+            print(inst, 'D', 1, "Reached time limit: %f", elapsed);
+            break;
+        }
+        double left = inst->time_limit - elapsed;
+
+        // fix edges and start from the best tour (the pool on the first round)
+        for(int p = 0; p < nworkers; p++){
+            hfworker *w = &workers[p];
+            CPXENVptr env = w->inst->CPXenv;
+            CPXsetdblparam(env, CPXPARAM_TimeLimit, (left < timelim) ? left : timelim);
+            CPXsetintparam(env, CPXPARAM_RandomSeed, (inst->seed + round * nworkers + p) & 0x7fffffff);
+            fix_edges(w->inst, inst->xbest, 0, w->rate, w->fixed, NULL);
+
+            int nstarts = CPXgetnummipstarts(env, w->inst->CPXlp);
+            if(nstarts > 0) CPXdelmipstarts(env, w->inst->CPXlp, 0, nstarts - 1);
+            w->inst->elite = (round == 0) ? elite : NULL;
+            w->inst->succ = inst->succ;
+            add_mipstarts(w->inst);
+        }
+
+        for(int p = 0; p < nworkers; p++)
+            if(pthread_create(&workers[p].thread, NULL, hfworker_run, &workers[p]))
+                printerr(inst, "Cannot create hard-fixing worker %d", p);
+        for(int p = 0; p < nworkers; p++)
+            pthread_join(workers[p].thread, NULL);
+
+        // share the best solution
+        hfworker *best = NULL;
+        for(int p = 0; p < nworkers; p++)
+            if(workers[p].found && (best == NULL || workers[p].z < best->z))
+                best = &workers[p];
+        if(best != NULL && best->z < inst->zbest - EPSILON){
+            inst->zbest = best->z;
+            // optimal in the fixed neighbourhood only
+            inst->status = CPXgetstat(best->inst->CPXenv, best->inst->CPXlp);
+            if(inst->status == CPXMIP_OPTIMAL || inst->status == CPXMIP_OPTIMAL_TOL)
+                inst->status = CPXMIP_TIME_LIM_FEAS;
+            memcpy(inst->xbest, best->x, inst->ncols * sizeof(double));
+            int ncomp;
+            findccomp(inst, inst->xbest, &ncomp, inst->succ, comp);
+            print(inst, 'D', 1, "Round %d: found better solution value zbest = %f (rate %.0f%%)",
+                  round + 1, inst->zbest, best->rate);
+        }else
+            print(inst, 'D', 1, "Round %d: no improvement", round + 1);
+    }
+    free(comp);
+    inst->elite = elite;
+
+    for(int p = 0; p < nworkers; p++){
+        hfworker *w = &workers[p];
+        if(p > 0){
+            free_cutsdata(w->copy.cbdata);
+            CPXfreeprob(w->copy.CPXenv, &w->copy.CPXlp);
+            CPXcloseCPLEX(&w->copy.CPXenv);
+        }
+        free(w->fixed);
+        free(w->x);
+    }
+    free(workers);
+
+    // copy solution
+    inst->xstar = (double *) calloc(inst->ncols, sizeof(double));
+    memcpy(inst->xstar, inst->xbest, inst->ncols * sizeof(double));
+    inst->zstar = inst->zbest;
+    if(inst->status == -1) inst->status = CPXMIP_TIME_LIM_FEAS;
+}
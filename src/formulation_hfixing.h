@@ -7,8 +7,16 @@
 
 #include "utils.h"
 
+#define HFIX_WORKERS 4      // max number of concurrent sub-MIPs (HFIXING6)
+#define HFIX_RATEMAX 90.0   // fixing probability of the first worker (percent)
+#define HFIX_RATEMIN 50.0   // fixing probability of the last worker (percent)
+
+int fix_edges(instance *inst, const double *xbest, double m, double q, bool *fixed, const double *xlp);
+
 void solve_hfixing(instance *inst);
 
+void solve_hfixing_portfolio(instance *inst);
+
 void get_solution_hfixing(instance *inst);
 
 void build_model_hfixing(instance *inst);
@@ -0,0 +1,116 @@
+//
+// Created by enrico on 19/07/21.
+//
+
+#include <sys/time.h>
+#include <pthread.h>
+#include "formulation_portfolio.h"
+#include "heuristic_VNS.h"
+#include "heuristic_tabu_search.h"
+
+// heuristic thread of the portfolio
+typedef struct{
+    instance copy;      // shallow copy of the instance with its own tour and time limit
+    sharedtour *shared;
+    _Atomic bool *stop; // set when CPLEX is done
+    unsigned int seed;  // private RNG state: kicks are reproducible and don't contend on rand()
+    pthread_t thread;
+} pfworker;
+
+/**
+ * Heuristic thread: restart VNS or tabu search from the shared tour every PORTFOLIO_SLICE seconds,
+ * and share the tour found if it's better.
+ */
+static void * pfworker_run(void *arg){
+    pfworker *w = (pfworker *) arg;
+    instance *inst = &w->copy;
+    double time_limit = inst->time_limit;
+    struct timeval now;
+    while(!atomic_load(w->stop) && !timeout(inst)){
+        double z;
+        shared_get(w->shared, inst->succ, &z);
+        inst->zbest = z;
+
+        gettimeofday(&now, NULL);
+        double elapsed = (double) (now.tv_sec - inst->tstart.tv_sec);
+        inst->time_limit = (elapsed + PORTFOLIO_SLICE < time_limit) ? elapsed + PORTFOLIO_SLICE : time_limit;
+        double znew = (inst->ref_heuristic == VNS2) ? VNS(inst, &w->seed) : tabu_search(inst, inst->succ, &w->seed);
+        inst->time_limit = time_limit;
+
+        if(shared_put(w->shared, inst->succ, znew))
+            print(inst, 'D', 1, "Portfolio: %s tour %f shared", ref_heuristic_names[inst->ref_heuristic], znew);
+    }
+    return NULL;
+}
+
+void build_model_portfolio(instance *inst){
+    build_model_cuts(inst);
+}
+
+/**
+ * Portfolio: CPLEX runs on the cuts formulation while VNS and tabu search threads run on the other cores.
+ * They share the best tour: the heuristics restart from it and the callback posts it to CPLEX when
+ * they improve it; CPLEX incumbents are shared as soon as they are found.
+ *
+ * @param inst general instance (model built by build_model_portfolio())
+ */
+void solve_portfolio(instance *inst){
+    int nheur = ncores() / 2;
+    if(nheur > PORTFOLIO_HTHREADS) nheur = PORTFOLIO_HTHREADS;
+    if(nheur < 1) nheur = 1;
+    int ncplex = (ncores() > nheur) ? ncores() - nheur : 1;
+
+    // shared tour: the warm start one
+    sharedtour *shared = new_sharedtour(inst->nnodes, inst->succ, inst->zbest);
+    install_cuts_callback(inst, ncplex);
+    share_incumbent(inst, shared);
+    print(inst, 'I', 1, "Portfolio: %d CPLEX threads, %d heuristic threads", ncplex, nheur);
+
+    _Atomic bool stop;
+    atomic_init(&stop, false);
+    pfworker *workers = (pfworker *) calloc(nheur, sizeof(pfworker));
+    for(int p = 0; p < nheur; p++){
+        pfworker *w = &workers[p];
+        w->copy = *inst;
+        w->copy.ref_heuristic = (p % 2 == 0) ? VNS2 : TABU_SEARCH2;
+        w->copy.succ = (int *) malloc(inst->nnodes * sizeof(int));
+        w->shared = shared;
+        w->stop = &stop;
+        w->seed = (unsigned int) inst->seed * 2654435761u + p + 1;
+        if(pthread_create(&w->thread, NULL, pfworker_run, w))
+            printerr(inst, "Cannot create portfolio worker %d", p);
+    }
+
+    if(CPXmipopt(inst->CPXenv, inst->CPXlp))
+        printerr(inst, "CPXmipopt() error!");
+    atomic_store(&stop, true);
+    for(int p = 0; p < nheur; p++){
+        pthread_join(workers[p].thread, NULL);
+        free(workers[p].copy.succ);
+    }
+    free(workers);
+    inst->status = CPXgetstat(inst->CPXenv, inst->CPXlp);
+
+    // the heuristics may have found a better tour after the last one posted
+    double z, zcplex = CPX_INFBOUND;
+    shared_get(shared, inst->succ, &z);
+    if(CPXgetobjval(inst->CPXenv, inst->CPXlp, &zcplex) || z < zcplex - EPSILON){
+        print(inst, 'I', 1, "Portfolio: heuristic tour %f is the best one", z);
+        inst->zbest = z;
+        inst->xstar = succtox(inst, inst->succ, false);
+        if(inst->status != CPXMIP_OPTIMAL && inst->status != CPXMIP_OPTIMAL_TOL)
+            inst->status = CPXMIP_TIME_LIM_FEAS;
+    }
+
+    ((cutsdata *) inst->cbdata)->shared = NULL;
+    free_sharedtour(shared);
+}
+
+void get_solution_portfolio(instance *inst){
+    if(inst->xstar == NULL){
+        get_solution_cuts(inst);
+        return;
+    }
+    // heuristic tour
+    inst->zstar = inst->zbest;
+}
@@ -0,0 +1,20 @@
+//
+// Created by enrico on 19/07/21.
+//
+
+#ifndef TSP_OP2_FORMULATION_PORTFOLIO_H
+#define TSP_OP2_FORMULATION_PORTFOLIO_H
+
+#include "utils.h"
+#include "formulation_cuts.h"
+
+#define PORTFOLIO_HTHREADS 2    // max number of heuristic threads (the other cores run CPLEX)
+#define PORTFOLIO_SLICE 5       // heuristic run between two restarts from the shared tour (seconds)
+
+void build_model_portfolio(instance *inst);
+
+void solve_portfolio(instance *inst);
+
+void get_solution_portfolio(instance *inst);
+
+#endif //TSP_OP2_FORMULATION_PORTFOLIO_H
@@ -0,0 +1,416 @@
+//
+// Sparse undirected models: missing edges are priced out on the subtour LP
+//
+
+#include <sys/time.h>
+#include "formulation_pricing.h"
+#include "formulation_cuts.h"
+#include "candidates.h"
+#include "unionfind.h"
+
+// subtour LP over the edge set: degree rows followed by rounds of subtour cuts x(delta(S)) >= 2,
+// one for each connected component S of the support graph
+typedef struct{
+    CPXLPptr lp;
+    int nrounds;
+    int **lab;          // lab[r][i]: component of node i in round r
+    int *first;         // first[r]: row of the cut on component 0 of round r
+    double *pi;         // duals of all the rows
+    double z;           // optimal value
+    bool valid;         // no missing edge has negative reduced cost, i.e. z is a lower bound on the full graph
+} rootlp;
+
+/**
+ * Sparse edge set: candidate lists plus the edges of a tour, so that the model is feasible.
+ *
+ * @param inst general instance
+ * @param succ heuristic tour
+ */
+void sparse_edges(instance *inst, const int *succ){
+    int n = inst->nnodes;
+    const int *cand = candidates(inst);
+    int ncand = inst->ncand;
+
+    free_edgeset(inst->edges);
+    inst->edges = new_edgeset(n, n * (ncand + 1));
+    for(int i = 0; i < n; i++)
+        for(int k = 0; k < ncand; k++)
+            edgeset_add(inst->edges, i, cand[i * ncand + k]);
+    for(int i = 0; i < n; i++)
+        edgeset_add(inst->edges, i, succ[i]);
+
+    print(inst, 'I', 1, "Sparse model: %d edges out of %lld", inst->edges->n, (long long) n * (n - 1) / 2);
+}
+
+/**
+ * Add a tour as MIP start of the sparse model: all its edges must be in the edge set.
+ *
+ * @param inst general instance
+ * @param succ tour
+ */
+void sparse_mipstart(instance *inst, const int *succ){
+    int n = inst->nnodes;
+    int *index = malloc(n * sizeof(int));
+    double *value = malloc(n * sizeof(double));
+    for(int i = 0; i < n; i++){
+        index[i] = edgeset_find(inst->edges, i, succ[i]);
+        value[i] = 1;
+        if(index[i] < 0) printerr(inst, "sparse_mipstart(): edge [%d, %d] is not in the model", i + 1, succ[i] + 1);
+    }
+    int beg[] = {0};
+    int effort[] = {CPX_MIPSTART_AUTO};
+    if(CPXaddmipstarts(inst->CPXenv, inst->CPXlp, 1, n, beg, index, value, effort, NULL))
+        print(inst, 'W', 1, "Can't add warm start");
+    free(index);
+    free(value);
+}
+
+static double reduced_cost(instance *inst, const rootlp *r, int i, int j){
+    double rc = cost(i, j, inst) - r->pi[i] - r->pi[j];
+    for(int t = 0; t < r->nrounds; t++){
+        int a = r->lab[t][i], b = r->lab[t][j];
+        if(a != b) rc -= r->pi[r->first[t] + a] + r->pi[r->first[t] + b];
+    }
+    return rc;
+}
+
+/**
+ * Add the edges [first, n) of the edge set as columns of the subtour LP,
+ * with their coefficients in the degree rows and in the cuts they cross.
+ */
+static void add_lp_columns(instance *inst, rootlp *r, int first){
+    edgeset *es = inst->edges;
+    int ccnt = es->n - first;
+    if(ccnt <= 0) return;
+
+    int cap = ccnt * (2 + 2 * r->nrounds);
+    int *beg = malloc(ccnt * sizeof(int));
+    int *ind = malloc(cap * sizeof(int));
+    double *val = malloc(cap * sizeof(double));
+    double *obj = malloc(ccnt * sizeof(double));
+    double *lb = calloc(ccnt, sizeof(double));
+    double *ub = malloc(ccnt * sizeof(double));
+
+    int nnz = 0;
+    for(int k = first; k < es->n; k++){
+        int i = es->u[k], j = es->v[k];
+        beg[k - first] = nnz;
+        obj[k - first] = cost(i, j, inst);
+        ub[k - first] = 1;
+        ind[nnz] = i; val[nnz++] = 1;
+        ind[nnz] = j; val[nnz++] = 1;
+        for(int t = 0; t < r->nrounds; t++){
+            int a = r->lab[t][i], b = r->lab[t][j];
+            if(a == b) continue;
+            ind[nnz] = r->first[t] + a; val[nnz++] = 1;
+            ind[nnz] = r->first[t] + b; val[nnz++] = 1;
+        }
+    }
+    int err = CPXaddcols(inst->CPXenv, r->lp, ccnt, nnz, obj, beg, ind, val, lb, ub, NULL);
+
+    free(beg); free(ind); free(val);
+    free(obj); free(lb); free(ub);
+    if(err) printerr(inst, "CPXaddcols(): error code %d", err);
+}
+
+/**
+ * Add a cut x(delta(S)) >= 2 for each connected component S of the support graph of x.
+ *
+ * @return false if the support graph is connected
+ */
+static bool add_cut_round(instance *inst, rootlp *r, const double *x){
+    edgeset *es = inst->edges;
+    int n = inst->nnodes;
+
+    unionfind *uf = new_unionfind(n);
+    for(int k = 0; k < es->n; k++)
+        if(x[k] > PRICING_EPS) uf_union(uf, es->u[k], es->v[k]);
+    int m = uf->nsets;
+    if(m == 1){
+        free_unionfind(uf);
+        return false;
+    }
+
+    // label components 0..m-1
+    int *lab = malloc(n * sizeof(int));
+    int *root = malloc(n * sizeof(int));
+    for(int i = 0; i < n; i++) root[i] = -1;
+    int c = 0;
+    for(int i = 0; i < n; i++){
+        int f = uf_find(uf, i);
+        if(root[f] < 0) root[f] = c++;
+        lab[i] = root[f];
+    }
+    free(root);
+    free_unionfind(uf);
+
+    // rows in CSR form: edge k is in the cuts of both its endpoints' components, if they differ
+    int *beg = calloc(m + 1, sizeof(int));
+    for(int k = 0; k < es->n; k++){
+        int a = lab[es->u[k]], b = lab[es->v[k]];
+        if(a == b) continue;
+        beg[a + 1]++;
+        beg[b + 1]++;
+    }
+    for(int s = 0; s < m; s++) beg[s + 1] += beg[s];
+    int nnz = beg[m];
+    int *ind = malloc((nnz > 0 ? nnz : 1) * sizeof(int));
+    double *val = malloc((nnz > 0 ? nnz : 1) * sizeof(double));
+    int *fill = malloc(m * sizeof(int));
+    memcpy(fill, beg, m * sizeof(int));
+    for(int k = 0; k < es->n; k++){
+        int a = lab[es->u[k]], b = lab[es->v[k]];
+        if(a == b) continue;
+        ind[fill[a]] = k; val[fill[a]++] = 1;
+        ind[fill[b]] = k; val[fill[b]++] = 1;
+    }
+    double *rhs = malloc(m * sizeof(double));
+    char *sense = malloc(m * sizeof(char));
+    for(int s = 0; s < m; s++){
+        rhs[s] = 2;
+        sense[s] = 'G';
+    }
+
+    r->lab = realloc(r->lab, (r->nrounds + 1) * sizeof(int *));
+    r->first = realloc(r->first, (r->nrounds + 1) * sizeof(int));
+    r->lab[r->nrounds] = lab;
+    r->first[r->nrounds] = CPXgetnumrows(inst->CPXenv, r->lp);
+    r->nrounds++;
+
+    int err = CPXaddrows(inst->CPXenv, r->lp, 0, m, nnz, rhs, sense, beg, ind, val, NULL, NULL);
+
+    free(beg); free(fill); free(ind); free(val);
+    free(rhs); free(sense);
+    if(err) printerr(inst, "CPXaddrows(): error code %d", err);
+    print(inst, 'D', 2, "Root LP: %d subtour cuts", m);
+    return true;
+}
+
+/**
+ * Scan all the node pairs missing from the edge set and add:
+ * if threshold < 0, the edge with the most negative reduced cost of each node (pricing);
+ * otherwise every edge with reduced cost < threshold (edges that can't be eliminated).
+ *
+ * @return number of edges added
+ */
+static int scan_missing(instance *inst, const rootlp *r, double threshold){
+    edgeset *es = inst->edges;
+    int n = inst->nnodes;
+    int first = es->n;
+    bool pricing = threshold < 0;
+
+    // adjacency lists of the edge set to skip the pairs already there
+    int *beg = calloc(n + 1, sizeof(int));
+    for(int k = 0; k < first; k++){
+        beg[es->u[k] + 1]++;
+        beg[es->v[k] + 1]++;
+    }
+    for(int i = 0; i < n; i++) beg[i + 1] += beg[i];
+    int *adj = malloc(2 * first * sizeof(int));
+    int *fill = malloc(n * sizeof(int));
+    memcpy(fill, beg, n * sizeof(int));
+    for(int k = 0; k < first; k++){
+        adj[fill[es->u[k]]++] = es->v[k];
+        adj[fill[es->v[k]]++] = es->u[k];
+    }
+    int *mark = malloc(n * sizeof(int));
+    for(int i = 0; i < n; i++) mark[i] = -1;
+
+    double *best = malloc(n * sizeof(double));
+    int *arg = malloc(n * sizeof(int));
+    for(int i = 0; i < n; i++){
+        best[i] = -PRICING_EPS;
+        arg[i] = -1;
+    }
+
+    for(int i = 0; i < n && !timeout(inst); i++){
+        for(int p = beg[i]; p < beg[i + 1]; p++) mark[adj[p]] = i;
+        for(int j = i + 1; j < n; j++){
+            if(mark[j] == i) continue;
+            double rc = reduced_cost(inst, r, i, j);
+            if(!pricing){
+                if(rc < threshold) edgeset_add(es, i, j);
+                continue;
+            }
+            if(rc < best[i]){ best[i] = rc; arg[i] = j; }
+            if(rc < best[j]){ best[j] = rc; arg[j] = i; }
+        }
+    }
+    if(pricing)
+        for(int i = 0; i < n; i++)
+            if(arg[i] >= 0) edgeset_add(es, i, arg[i]);
+
+    free(beg); free(adj); free(fill); free(mark);
+    free(best); free(arg);
+    return es->n - first;
+}
+
+/**
+ * Solve the subtour LP (with component cuts only) on the edge set, adding the missing edges
+ * with negative reduced cost until there are none: then its value is a lower bound on the full graph.
+ *
+ * @param inst general instance
+ * @param r returned LP, its duals and cuts
+ */
+static void subtour_lp(instance *inst, rootlp *r){
+    int n = inst->nnodes;
+    int err;
+    r->lp = CPXcreateprob(inst->CPXenv, &err, "subtour");
+    if(err) printerr(inst, "Can't create subtour LP");
+
+    // degree rows, then the columns
+    double *rhs = malloc(n * sizeof(double));
+    char *sense = malloc(n * sizeof(char));
+    for(int i = 0; i < n; i++){
+        rhs[i] = 2;
+        sense[i] = 'E';
+    }
+    err = CPXnewrows(inst->CPXenv, r->lp, n, rhs, sense, NULL, NULL);
+    free(rhs);
+    free(sense);
+    if(err) printerr(inst, "CPXnewrows(): error code %d", err);
+    add_lp_columns(inst, r, 0);
+
+    double *x = NULL;
+    int priced = 0;
+    while(!timeout(inst)){
+        if(CPXlpopt(inst->CPXenv, r->lp) || CPXgetstat(inst->CPXenv, r->lp) != CPX_STAT_OPTIMAL){
+            print(inst, 'W', 1, "Can't solve the subtour LP");
+            break;
+        }
+        int ncols = CPXgetnumcols(inst->CPXenv, r->lp);
+        x = realloc(x, ncols * sizeof(double));
+        CPXgetx(inst->CPXenv, r->lp, x, 0, ncols - 1);
+        if(r->nrounds < PRICING_MAXROUNDS && add_cut_round(inst, r, x)) continue;
+
+        int nrows = CPXgetnumrows(inst->CPXenv, r->lp);
+        r->pi = realloc(r->pi, nrows * sizeof(double));
+        CPXgetpi(inst->CPXenv, r->lp, r->pi, 0, nrows - 1);
+        CPXgetobjval(inst->CPXenv, r->lp, &r->z);
+
+        int first = inst->edges->n;
+        int added = scan_missing(inst, r, -1);
+        if(timeout(inst)) break;
+        if(added == 0){
+            r->valid = true;
+            break;
+        }
+        priced += added;
+        print(inst, 'D', 2, "Root LP: z = %f, %d edges with negative reduced cost", r->z, added);
+        add_lp_columns(inst, r, first);
+    }
+    free(x);
+
+    print(inst, 'I', 1, "Root LP: z = %f, %d subtour cut rounds, %d edges priced in%s",
+          r->z, r->nrounds, priced, r->valid ? "" : " (not a lower bound)");
+}
+
+static void free_rootlp(instance *inst, rootlp *r){
+    CPXfreeprob(inst->CPXenv, &r->lp);
+    for(int t = 0; t < r->nrounds; t++) free(r->lab[t]);
+    free(r->lab);
+    free(r->first);
+    free(r->pi);
+}
+
+/**
+ * Add the edges [first, n) of the edge set to the MIP: binary columns and degree coefficients
+ * (degree rows come first in the model, the subtour cuts are handled by the callback).
+ */
+static void add_mip_columns(instance *inst, int first){
+    edgeset *es = inst->edges;
+    int ccnt = es->n - first;
+    if(ccnt <= 0) return;
+
+    colbatch *b = new_colbatch(inst, ccnt);
+    for(int k = first; k < es->n; k++)
+        colbatch_add(b, cost(es->u[k], es->v[k], inst), 0.0, 1.0, 'B', "x(%d,%d)", es->u[k] + 1, es->v[k] + 1);
+    if(b->first != first) printerr(inst, "add_mip_columns(): columns and edges are out of sync!");
+    colbatch_submit(inst, b);
+
+    int *row = malloc(2 * ccnt * sizeof(int));
+    int *col = malloc(2 * ccnt * sizeof(int));
+    double *val = malloc(2 * ccnt * sizeof(double));
+    for(int k = first; k < es->n; k++){
+        int p = 2 * (k - first);
+        row[p] = es->u[k]; col[p] = k; val[p] = 1;
+        row[p + 1] = es->v[k]; col[p + 1] = k; val[p + 1] = 1;
+    }
+    int err = CPXchgcoeflist(inst->CPXenv, inst->CPXlp, 2 * ccnt, row, col, val);
+    free(row); free(col); free(val);
+    if(err) printerr(inst, "CPXchgcoeflist(): error code %d", err);
+
+    inst->ncols = CPXgetnumcols(inst->CPXenv, inst->CPXlp);
+    resize_cutsdata(inst);
+}
+
+/**
+ * Solve the sparse model and prove optimality over the full graph:
+ * 1. price the missing edges on the subtour LP, which gives a lower bound z_LP and reduced costs rc;
+ * 2. solve the MIP on the edge set;
+ * 3. a tour through a missing edge e costs at least z_LP + rc(e): if it's not worse than the MIP optimum
+ *    for every missing edge we're done, otherwise add the edges which can't be eliminated and go to 2.
+ * If the proof can't be completed the status is downgraded to feasible.
+ *
+ * @param inst general instance (edge set and MIP already built)
+ */
+void solve_sparse(instance *inst){
+    edgeset *es = inst->edges;
+    int n = inst->nnodes;
+    rootlp r = {NULL, 0, NULL, NULL, NULL, 0, false};
+
+    int first = es->n;
+    subtour_lp(inst, &r);
+    add_mip_columns(inst, first);
+    print(inst, 'I', 1, "Sparse model: %d edges after pricing", es->n);
+
+    int *succ = malloc(n * sizeof(int));
+    int *comp = malloc(n * sizeof(int));
+    double *x = NULL;
+    while(true){
+        // update time limit
+        struct timeval now;
+        gettimeofday(&now, NULL);
+        double left = inst->time_limit - (double) (now.tv_sec - inst->tstart.tv_sec);
+        if(CPXsetdblparam(inst->CPXenv, CPXPARAM_TimeLimit, (left > 1) ? left : 1))
+            print(inst, 'W', 1, "Error setting time limit.");
+
+        if(CPXmipopt(inst->CPXenv, inst->CPXlp))
+            printerr(inst, "CPXmipopt() error!");
+
+        int status = CPXgetstat(inst->CPXenv, inst->CPXlp);
+        if(status != CPXMIP_OPTIMAL && status != CPXMIP_OPTIMAL_TOL)
+            break; // CPLEX status says it all
+        if(!r.valid){
+            print(inst, 'W', 1, "Sparse model: optimality on the full graph can't be proven");
+            inst->status = CPXMIP_TIME_LIM_FEAS;
+            break;
+        }
+
+        double z;
+        CPXgetobjval(inst->CPXenv, inst->CPXlp, &z);
+        first = es->n;
+        int added = scan_missing(inst, &r, z - r.z - PRICING_EPS * (1 + fabs(z)));
+        if(timeout(inst)){
+            print(inst, 'W', 1, "Sparse model: time limit reached while eliminating edges");
+            inst->status = CPXMIP_TIME_LIM_FEAS;
+            break;
+        }
+        print(inst, 'I', 1, "Sparse model: z* = %f, z_LP = %f, %d edges can't be eliminated", z, r.z, added);
+        if(added == 0)
+            break; // optimal on the full graph
+
+        // add them and keep the incumbent as warm start
+        x = realloc(x, first * sizeof(double));
+        int ncomp;
+        CPXgetx(inst->CPXenv, inst->CPXlp, x, 0, first - 1);
+        findccomp(inst, x, &ncomp, succ, comp);
+        add_mip_columns(inst, first);
+        if(ncomp == 1) sparse_mipstart(inst, succ);
+    }
+
+    free(x);
+    free(succ);
+    free(comp);
+    free_rootlp(inst, &r);
+}
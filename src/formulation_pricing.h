@@ -0,0 +1,22 @@
+//
+// Created by enrico on 12/07/21.
+//
+
+#ifndef TSP_OP2_FORMULATION_PRICING_H
+#define TSP_OP2_FORMULATION_PRICING_H
+
+#include <cplex.h>
+
+#include "utils.h"
+#include "formulation_commons.h"
+
+#define PRICING_EPS 1e-6        // reduced cost tolerance
+#define PRICING_MAXROUNDS 1000  // max number of subtour cut rounds in the root LP
+
+void sparse_edges(instance *inst, const int *succ);
+
+void sparse_mipstart(instance *inst, const int *succ);
+
+void solve_sparse(instance *inst);
+
+#endif //TSP_OP2_FORMULATION_PRICING_H
@@ -0,0 +1,146 @@
+//
+// Created by enrico on 15/07/21.
+//
+
+#include <sys/time.h>
+#include "formulation_proximity.h"
+#include "heuristics.h"
+
+void build_model_proximity(instance *inst){
+    build_model_cuts(inst);
+    inst->ncols = CPXgetnumcols(inst->CPXenv, inst->CPXlp);
+    inst->nrows = CPXgetnumrows(inst->CPXenv, inst->CPXlp);
+
+    // objective cutoff: sum c_e x_e <= zbest - theta (the rhs is set by solve_proximity())
+    int *index = (int *) malloc(inst->ncols * sizeof(int));
+    double *value = (double *) malloc(inst->ncols * sizeof(double));
+    for(int i = 0, k = 0; i < inst->nnodes; i++)
+        for(int j = i + 1; j < inst->nnodes; j++, k++){
+            index[k] = k;
+            value[k] = cost(i, j, inst);
+        }
+    double rhs = CPX_INFBOUND;
+    char sense = 'L';
+    int beg = 0;
+    char *rname = "cutoff";
+    if(CPXaddrows(inst->CPXenv, inst->CPXlp, 0, 1, inst->ncols, &rhs, &sense, &beg, index, value, NULL, &rname))
+        printerr(inst, "CPXaddrows(): error adding the cutoff constraint");
+    free(index);
+    free(value);
+}
+
+/**
+ * Set the proximity objective: number of edges not in the reference tour.
+ * Every tour has nnodes edges, so it's half the Hamming distance from the reference.
+ * Only the coefficients which change are updated, i.e. at most 2 * nnodes.
+ *
+ * @param inst general instance
+ * @param xref reference tour
+ * @param obj current objective coefficients, updated
+ */
+static void set_proximity(instance *inst, const double *xref, double *obj){
+    int *indices = (int *) malloc(inst->ncols * sizeof(int));
+    double *values = (double *) malloc(inst->ncols * sizeof(double));
+    int nchg = 0;
+    for(int k = 0; k < inst->ncols; k++){
+        double c = (xref[k] > 0.5) ? 0 : 1;
+        if(c == obj[k]) continue;
+        obj[k] = c;
+        indices[nchg] = k;
+        values[nchg++] = c;
+    }
+    if(nchg > 0 && CPXchgobj(inst->CPXenv, inst->CPXlp, nchg, indices, values))
+        printerr(inst, "CPXchgobj() error");
+    print(inst, 'D', 2, "Proximity objective: %d coefficients changed", nchg);
+    free(indices);
+    free(values);
+}
+
+/**
+ * Proximity search: starting from a heuristic tour, look for a tour which costs at least theta less
+ * and is as close as possible to the current one (the objective is the Hamming distance).
+ * Each sub-MIP stops at its first solution, which becomes the new reference tour after 2-opt.
+ * Theta is halved when a sub-MIP times out or proves that no such tour exists.
+ * Subtours are removed by the cuts callback, which also posts its heuristic tours if they satisfy the cutoff.
+ *
+ * @param inst general instance (model built by build_model_proximity())
+ */
+void solve_proximity(instance *inst){
+    double timelim = inst->time_limit / 20;
+    int n = inst->nnodes;
+    cutsdata *data = inst->cbdata;
+
+    // starting tour
+    warm_start(inst, GREEDY);
+    inst->directed = false;
+    free(inst->xbest);
+    inst->xbest = succtox(inst, inst->succ, false);
+    inst->status = CPXMIP_TIME_LIM_FEAS;
+    double theta = PROX_THETA0 * inst->zbest;
+
+    // the objective is the edge cost: it's replaced on the first iteration
+    double *obj = (double *) malloc(inst->ncols * sizeof(double));
+    for(int k = 0; k < inst->ncols; k++) obj[k] = -1;
+    data->obj = obj;
+
+    CPXsetintparam(inst->CPXenv, CPXPARAM_MIP_Limits_Solutions, 1);
+    double *x = (double *) malloc(inst->ncols * sizeof(double));
+    int *comp = (int *) malloc(n * sizeof(int));
+    tour *t = new_tour(n);
+    nodequeue *q = new_nodequeue(n);
+    int cutoff = inst->nrows;
+    struct timeval now;
+    while(true){
+        // check time limit
+        gettimeofday(&now, NULL);
+        double elapsed = (double) (now.tv_sec - inst->tstart.tv_sec);
+        if(elapsed >= inst->time_limit) {
+            print(inst, 'D', 1, "Reached time limit: %f", elapsed);
+            break;
+        }
+        double left = inst->time_limit - elapsed;
+        CPXsetdblparam(inst->CPXenv, CPXPARAM_TimeLimit, (left < timelim) ? left : timelim);
+
+        // move the proximity center and the cutoff
+        set_proximity(inst, inst->xbest, obj);
+        data->cutoff = inst->zbest - theta;
+        if(CPXchgrhs(inst->CPXenv, inst->CPXlp, 1, &cutoff, &data->cutoff))
+            printerr(inst, "CPXchgrhs() error");
+
+        CPXmipopt(inst->CPXenv, inst->CPXlp);
+        int lpstat = CPXgetstat(inst->CPXenv, inst->CPXlp);
+
+        if(CPXgetx(inst->CPXenv, inst->CPXlp, x, 0, inst->ncols - 1)){
+            // no better tour: ask for a smaller improvement
+            if(lpstat == CPXMIP_INFEASIBLE && theta <= PROX_THETAMIN * inst->zbest){
+                print(inst, 'I', 1, "Proximity search: no tour better than %f", data->cutoff);
+                inst->status = CPXMIP_OPTIMAL_TOL;
+                break;
+            }
+            theta /= 2;
+            if(theta < PROX_THETAMIN * inst->zbest) theta = PROX_THETAMIN * inst->zbest;
+            print(inst, 'D', 1, "Proximity search: no solution (status %d), theta = %f", lpstat, theta);
+            continue;
+        }
+
+        // new reference tour, refined by 2-opt
+        int ncomp;
+        findccomp(inst, x, &ncomp, inst->succ, comp);
+        inst->zbest = patch_tour(inst, inst->succ, comp, ncomp, t, q);
+        free(inst->xbest);
+        inst->xbest = succtox(inst, inst->succ, false);
+        print(inst, 'D', 1, "Proximity search: zbest = %f", inst->zbest);
+    }
+    data->obj = NULL;
+
+    free(obj);
+    free(x);
+    free(comp);
+    free_tour(t);
+    free_nodequeue(q);
+
+    // copy solution
+    inst->xstar = (double *) calloc(inst->ncols, sizeof(double));
+    memcpy(inst->xstar, inst->xbest, inst->ncols * sizeof(double));
+    inst->zstar = inst->zbest;
+}
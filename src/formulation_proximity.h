@@ -0,0 +1,18 @@
+//
+// Created by enrico on 15/07/21.
+//
+
+#ifndef TSP_OP2_FORMULATION_PROXIMITY_H
+#define TSP_OP2_FORMULATION_PROXIMITY_H
+
+#include "utils.h"
+#include "formulation_cuts.h"
+
+#define PROX_THETA0 1e-2    // initial cost improvement required by the cutoff (fraction of zbest)
+#define PROX_THETAMIN 1e-4  // min cost improvement: below it the search stops (fraction of zbest)
+
+void build_model_proximity(instance *inst);
+
+void solve_proximity(instance *inst);
+
+#endif //TSP_OP2_FORMULATION_PROXIMITY_H
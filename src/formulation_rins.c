@@ -0,0 +1,193 @@
+//
+// Created by enrico on 16/07/21.
+//
+
+#include <sys/time.h>
+#include "formulation_rins.h"
+#include "formulation_hfixing.h"
+#include "heuristics.h"
+
+// separation on the root LP
+typedef struct{
+    instance *inst;
+    CPXLPptr lp;
+    int *index;         // SEC columns
+    double *value;      // all ones
+    bool *mark;         // nodes of the cut
+    int *other;         // nodes of the complement
+    int ncuts;
+} lpcuts;
+
+/**
+ * Add the SEC on the smaller side of the cut (S, V \ S) to the root LP: with the degree
+ * constraints x(E(S)) <= |S| - 1 and x(E(V \ S)) <= |V \ S| - 1 are equivalent.
+ * Called by separate_sec() for each violated SEC.
+ */
+static void add_lp_sec(void *param, int cutcount, const int *cut){
+    lpcuts *p = (lpcuts *) param;
+    instance *inst = p->inst;
+    int n = inst->nnodes;
+    if(cutcount < 2 || cutcount > n - 2 || p->ncuts >= RELAX_MAXCUTS) return;
+
+    const int *nodes = cut;
+    int size = cutcount;
+    if(2 * cutcount > n){
+        for(int i = 0; i < n; i++) p->mark[i] = false;
+        for(int i = 0; i < cutcount; i++) p->mark[cut[i]] = true;
+        size = 0;
+        for(int i = 0; i < n; i++)
+            if(!p->mark[i]) p->other[size++] = i;
+        nodes = p->other;
+    }
+
+    int nnz = 0;
+    for(int a = 0; a < size; a++)
+        for(int b = a + 1; b < size; b++)
+            p->index[nnz++] = xpos_undirected(nodes[a], nodes[b], inst);
+    double rhs = size - 1;
+    char sense = 'L';
+    int beg = 0;
+    if(CPXaddrows(inst->CPXenv, p->lp, 0, 1, nnz, &rhs, &sense, &beg, p->index, p->value, NULL, NULL))
+        printerr(inst, "CPXaddrows(): error adding a SEC to the root LP");
+    p->ncuts++;
+}
+
+/**
+ * Solve the LP relaxation of the model with the SECs found by separate_sec().
+ * The LP is a copy of the model, which is left unchanged.
+ *
+ * @param inst general instance
+ * @param xlp returned LP solution (unchanged if the LP can't be solved)
+ */
+static void root_lp(instance *inst, double *xlp){
+    int n = inst->nnodes;
+    int err;
+    CPXLPptr lp = CPXcloneprob(inst->CPXenv, inst->CPXlp, &err);
+    if(err) printerr(inst, "Can't copy the model (error %d)", err);
+    if(CPXchgprobtype(inst->CPXenv, lp, CPXPROB_LP))
+        printerr(inst, "CPXchgprobtype() error");
+
+    lpcuts p = {inst, lp, NULL, NULL, NULL, NULL, 0};
+    p.index = (int *) malloc(inst->ncols * sizeof(int));
+    p.value = (double *) malloc(inst->ncols * sizeof(double));
+    for(int k = 0; k < inst->ncols; k++) p.value[k] = 1;
+    p.mark = (bool *) malloc(n * sizeof(bool));
+    p.other = (int *) malloc(n * sizeof(int));
+    cutsthread t = {0};
+    alloc_workspace(inst, &t);
+    double *x = t.xstar;
+
+    int rounds = 0, tot = 0;
+    double z = 0;
+    while(rounds < RELAX_ROOTROUNDS && !timeout(inst)){
+        if(CPXlpopt(inst->CPXenv, lp) || CPXgetx(inst->CPXenv, lp, x, 0, inst->ncols - 1)){
+            print(inst, 'W', 1, "Can't solve the root LP");
+            break;
+        }
+        CPXgetobjval(inst->CPXenv, lp, &z);
+        memcpy(xlp, x, inst->ncols * sizeof(double));
+        rounds++;
+
+        p.ncuts = 0;
+        int ncomp;
+        separate_sec(inst, &t, add_lp_sec, &p, &ncomp);
+
+        tot += p.ncuts;
+        print(inst, 'D', 2, "Root LP: z = %f, %d SECs (%d components)", z, p.ncuts, ncomp);
+        if(p.ncuts == 0) break;
+    }
+    print(inst, 'I', 1, "Root LP: z = %f, %d rounds, %d SECs", z, rounds, tot);
+
+    CPXfreeprob(inst->CPXenv, &lp);
+    free(p.index);
+    free(p.value);
+    free(p.mark);
+    free(p.other);
+    free_workspace(&t);
+}
+
+/**
+ * Relaxation induced neighbourhood search: the edges of the best tour which are at 1 in the root LP
+ * solution are fixed, and the sub-MIP on the other ones is solved with a short time limit.
+ * This is repeated from each new best tour; when a sub-MIP is exhausted without improvement
+ * the agreeing edges are fixed with a decreasing probability, when it times out its time limit grows.
+ *
+ * @param inst general instance (model built by build_model_hfixing())
+ */
+void solve_rins(instance *inst){
+    double timelim = inst->time_limit / 20;
+    double rate = 100;      // fixing probability of the agreeing edges (percent)
+    int n = inst->nnodes;
+
+    // starting tour
+    warm_start(inst, GREEDY);
+    inst->directed = false;
+    free(inst->xbest);
+    inst->xbest = succtox(inst, inst->succ, false);
+    inst->status = CPXMIP_TIME_LIM_FEAS;
+
+    double *xlp = (double *) calloc(inst->ncols, sizeof(double));
+    root_lp(inst, xlp);
+
+    bool *fixed = (bool *) calloc(inst->ncols, sizeof(bool));
+    double *x = (double *) malloc(inst->ncols * sizeof(double));
+    int *comp = (int *) malloc(n * sizeof(int));
+    tour *t = new_tour(n);
+    nodequeue *q = new_nodequeue(n);
+    tourpool *elite = inst->elite;
+    struct timeval now;
+    for(int round = 0; ; round++){
+        // check time limit
+        gettimeofday(&now, NULL);
+        double elapsed = (double) (now.tv_sec - inst->tstart.tv_sec);
+        if(elapsed >= inst->time_limit) {
+            print(inst, 'D', 1, "Reached time limit: %f", elapsed);
+            break;
+        }
+        double left = inst->time_limit - elapsed;
+        CPXsetdblparam(inst->CPXenv, CPXPARAM_TimeLimit, (left < timelim) ? left : timelim);
+
+        // fix the agreeing edges and start from the best tour (the pool on the first round)
+        fix_edges(inst, inst->xbest, 0, rate, fixed, xlp);
+        int nstarts = CPXgetnummipstarts(inst->CPXenv, inst->CPXlp);
+        if(nstarts > 0) CPXdelmipstarts(inst->CPXenv, inst->CPXlp, 0, nstarts - 1);
+        inst->elite = (round == 0) ? elite : NULL;
+        add_mipstarts(inst);
+
+        CPXmipopt(inst->CPXenv, inst->CPXlp);
+        int lpstat = CPXgetstat(inst->CPXenv, inst->CPXlp);
+
+        double z;
+        if(!CPXgetx(inst->CPXenv, inst->CPXlp, x, 0, inst->ncols - 1) &&
+           !CPXgetobjval(inst->CPXenv, inst->CPXlp, &z) && z < inst->zbest - EPSILON){
+            // new best tour, refined by 2-opt
+            int ncomp;
+            findccomp(inst, x, &ncomp, inst->succ, comp);
+            inst->zbest = patch_tour(inst, inst->succ, comp, ncomp, t, q);
+            free(inst->xbest);
+            inst->xbest = succtox(inst, inst->succ, false);
+            rate = 100;
+            print(inst, 'D', 1, "RINS: zbest = %f", inst->zbest);
+        }else if(lpstat == CPXMIP_OPTIMAL || lpstat == CPXMIP_OPTIMAL_TOL || lpstat == CPXMIP_INFEASIBLE){
+            // neighbourhood exhausted: fix less edges
+            rate = (rate - RINS_RATESTEP > RINS_RATEMIN) ? rate - RINS_RATESTEP : RINS_RATEMIN;
+            print(inst, 'D', 1, "RINS: neighbourhood exhausted, fixing rate = %.0f%%", rate);
+        }else{
+            timelim += 0.5 * timelim;
+            print(inst, 'D', 1, "RINS: no improvement, increasing individual time-limit to %f", timelim);
+        }
+    }
+    inst->elite = elite;
+
+    free(xlp);
+    free(fixed);
+    free(x);
+    free(comp);
+    free_tour(t);
+    free_nodequeue(q);
+
+    // copy solution
+    inst->xstar = (double *) calloc(inst->ncols, sizeof(double));
+    memcpy(inst->xstar, inst->xbest, inst->ncols * sizeof(double));
+    inst->zstar = inst->zbest;
+}
@@ -0,0 +1,16 @@
+//
+// Created by enrico on 16/07/21.
+//
+
+#ifndef TSP_OP2_FORMULATION_RINS_H
+#define TSP_OP2_FORMULATION_RINS_H
+
+#include "utils.h"
+#include "formulation_cuts.h"
+
+#define RINS_RATESTEP 10.0  // fixing probability decrease when a neighbourhood is exhausted (percent)
+#define RINS_RATEMIN 50.0   // min fixing probability of the agreeing edges (percent)
+
+void solve_rins(instance *inst);
+
+#endif //TSP_OP2_FORMULATION_RINS_H
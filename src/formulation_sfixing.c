@@ -3,9 +3,10 @@
 //
 
 #include <sys/time.h>
+#include <float.h>
 #include "formulation_sfixing.h"
 #include "plot.h"
-#include "heuristic_greedy.h"
+#include "heuristics.h"
 
 void build_model_sfixing(instance *inst){
     build_model_cuts(inst);
@@ -62,17 +63,67 @@ void addcnstr(instance *inst, int k){
     free(rname[0]);
 }
 
+/**
+ * Update the local branching controller after a sub-MIP, in the style of variable neighbourhood local branching:
+ * - improved: intensify around the new solution (smallest k), and shorten the time limit if it was fast;
+ * - neighbourhood exhausted (proven locally optimal): enlarge it, extending max_k when all of them are exhausted;
+ * - stopped before a proof: shrink the neighbourhood, or give more time if it's already the smallest one.
+ *
+ * @param inst general instance
+ * @param c controller
+ * @param outcome sub-MIP outcome
+ * @param used time used by the sub-MIP
+ * @return false iff the neighbourhood of size n is exhausted, i.e. the solution is optimal
+ */
+static bool lb_update(instance *inst, lbcontrol *c, enum lb_outcome outcome, double used){
+    switch(outcome){
+        case LB_IMPROVED:
+            c->k = c->min_k;
+            c->max_k = c->max_k0;
+            if(used < c->timelim / 2)
+                c->timelim = (c->timelim * SFIX_SHRINK > c->min_time) ? c->timelim * SFIX_SHRINK : c->min_time;
+            break;
+        case LB_EXHAUSTED:
+            if(c->k >= inst->nnodes) return false;
+            c->k += c->step;
+            if(c->k > c->max_k){
+                // every neighbourhood up to max_k is exhausted: go farther instead of solving them again
+                int grow = SFIX_NSTEPS * c->step;
+                c->max_k = (c->max_k + grow < inst->nnodes) ? c->max_k + grow : inst->nnodes;
+                if(c->k > c->max_k) c->k = c->max_k;
+            }
+            if(used < c->timelim / 2)
+                c->timelim = (c->timelim * SFIX_SHRINK > c->min_time) ? c->timelim * SFIX_SHRINK : c->min_time;
+            break;
+        case LB_STOPPED:
+            if(c->k > c->min_k)
+                c->k = (c->k - c->step > c->min_k) ? c->k - c->step : c->min_k;
+            else
+                c->timelim = (c->timelim * SFIX_GROW < c->max_time) ? c->timelim * SFIX_GROW : c->max_time;
+            break;
+    }
+    print(inst, 'D', 1, "Local branching: %s in %.1fs, next k = %d (max %d), time limit = %.1fs",
+          (outcome == LB_IMPROVED) ? "improved" : (outcome == LB_EXHAUSTED) ? "exhausted" : "stopped",
+          used, c->k, c->max_k, c->timelim);
+    return true;
+}
+
+static double wallclock(){
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    return (double) now.tv_sec + (double) now.tv_usec / 1e6;
+}
+
 void solve_sfixing(instance *inst){
-    // set short time limit
-    double timelim = inst->time_limit / 20;
     double zbest;
     double *xbest;
 
-    // local branching parameters
-    int min_k = (int) (0.1 * inst->nnodes);
-    if(min_k < 2) min_k = 2;
-    int max_k = 2 * min_k;
-    if(max_k > inst->nnodes) max_k = inst->nnodes;
+    // local branching controller
+    lbcontrol c;
+    c.min_k = (int) (0.1 * inst->nnodes);
+    if(c.min_k < 2) c.min_k = 2;
+    c.max_k = 2 * c.min_k;
+    c.timelim = inst->time_limit / 20;
 
     CPXsetintparam(inst->CPXenv, CPXPARAM_MIP_Limits_Solutions, 1);
     CPXsetintparam(inst->CPXenv, CPXPARAM_Emphasis_MIP,
@@ -81,76 +132,69 @@ void solve_sfixing(instance *inst){
     // allocate arrays and variables
     xbest = (double *) calloc(inst->ncols, sizeof(double));
     inst->xbest = (double *) calloc(inst->ncols, sizeof(double));
-    struct timeval now;
 
     // indices for warm start
-    int varindices[inst->ncols];
+    int *varindices = (int *) malloc(inst->ncols * sizeof(int));
     for(int i = 0; i < inst->ncols; i++) varindices[i] = i;
     int beg[] = {0};
-
-    // local branching parameter
-    int k = min_k;//2;
+    int effort[] = {CPX_MIPSTART_AUTO};
 
     // need initialization on first iteration
     bool init = true;
 
-    // max number of integer solution per sub-problem
-    long nsol = 1;
+    // max number of integer solution per sub-problem (after initialization): stop at the first improvement
+    long nsol = (inst->formulation == SFIXING1) ? 9223372036800000000L : 2;
 
-    if(inst->formulation == SFIXING3 || inst->formulation == SFIXING4) {
+    // heuristic warm start (--warm-start chain or greedy)
+    if(inst->formulation == SFIXING3 || inst->formulation == SFIXING4 || inst->ws_cons != CHLAST) {
         init = false;
-        free(inst->xbest);
-        if(inst->formulation == SFIXING4)
-            inst->cons_heuristic = GREEDYGRASP;
-        greedy(inst, inst->time_limit/10);
+        warm_start(inst, (inst->formulation == SFIXING4) ? GREEDYGRASP : GREEDY);
         inst->directed = false;
-        for(int i = 0; i < inst->nnodes; i++){
-            for(int j = 0; j < inst->nnodes; j++){
-                if(inst->xbest[xpos_directed(i,j,inst)] > 0.5)
-                    xbest[xpos_undirected(i,j,inst)] = 1;
-            }
-        }
         free(inst->xbest);
-        inst->xbest = xbest;
-        xbest = (double *) calloc(inst->ncols, sizeof(double));
-        nsol = 2;
-        min_k = 5;
-        max_k = 20;
+        inst->xbest = succtox(inst, inst->succ, false);
+        add_mipstarts(inst);
+        c.min_k = 5;
+        c.max_k = 20;
         //plot(inst, inst->xbest);
     }
+    if(c.max_k > inst->nnodes) c.max_k = inst->nnodes;
+    if(c.min_k > c.max_k) c.min_k = c.max_k;
+    c.k = c.min_k;
+    c.max_k0 = c.max_k;
+    c.step = (c.max_k - c.min_k) / SFIX_NSTEPS;
+    if(c.step < 1) c.step = 1;
+    c.min_time = c.timelim / 4;
+    c.max_time = inst->time_limit / 4;
 
     while(true){
         // check time limit
-        gettimeofday(&now, NULL);
-        double elapsed = (double) (now.tv_sec - inst->tstart.tv_sec) ;
+        double elapsed = wallclock() - (double) inst->tstart.tv_sec - (double) inst->tstart.tv_usec / 1e6;
         if(elapsed >= inst->time_limit) {
             print(inst, 'D', 1, "Reached time limit: %f", elapsed);
             break;
         }
         double left = inst->time_limit - elapsed;
 
-
         if(!init) {
             // set short time limit
-            if(inst->formulation == SFIXING1)
-                CPXsetdblparam(inst->CPXenv, CPXPARAM_TimeLimit, (left < timelim)? left:timelim);
-            else{
-                CPXsetdblparam(inst->CPXenv, CPXPARAM_TimeLimit, left);
-                CPXsetlongparam(inst->CPXenv, CPXPARAM_MIP_Limits_Solutions, nsol);
-            }
+            CPXsetdblparam(inst->CPXenv, CPXPARAM_TimeLimit, (left < c.timelim) ? left : c.timelim);
+            CPXsetlongparam(inst->CPXenv, CPXPARAM_MIP_Limits_Solutions, nsol);
 
             // add local branching constraints
-            addcnstr(inst, k);
+            addcnstr(inst, c.k);
 
-            // add warm start
-            CPXaddmipstarts(inst->CPXenv, inst->CPXlp, 1, inst->ncols, beg, varindices, inst->xbest,
-                            CPX_MIPSTART_AUTO, NULL);
-            // save model
-            save_model(inst);
+            // warm start from the current solution only
+            int nstarts = CPXgetnummipstarts(inst->CPXenv, inst->CPXlp);
+            if(nstarts > 0) CPXdelmipstarts(inst->CPXenv, inst->CPXlp, 0, nstarts - 1);
+            if(CPXaddmipstarts(inst->CPXenv, inst->CPXlp, 1, inst->ncols, beg, varindices, inst->xbest, effort, NULL))
+                print(inst, 'W', 1, "Can't add warm start");
         }
 
         // solve until (short) time limit or node limit expires
+        double t0 = wallclock();
         CPXmipopt(inst->CPXenv, inst->CPXlp);
+        double used = wallclock() - t0;
+        int lpstat = CPXgetstat(inst->CPXenv, inst->CPXlp);
 
         // get solution
         int status = CPXgetx(inst->CPXenv, inst->CPXlp, xbest, 0, inst->ncols - 1);
@@ -162,8 +206,8 @@ void solve_sfixing(instance *inst){
                 inst->zbest = inst->zstar = DBL_MAX;
                 break;
             }else {
-                timelim +=  0.75 * timelim;
-                print(inst, 'W', 1, "Not enough time to find an incumbent solution! (code %d)\n\tIncreasing individual time-limit to %f", status, timelim);
+                print(inst, 'W', 1, "Not enough time to find an incumbent solution! (code %d)", status);
+                lb_update(inst, &c, LB_STOPPED, used);
                 if(CPXdelrows(inst->CPXenv, inst->CPXlp, inst->nrows, inst->nrows))
                     printerr(inst, "Cannot delete row %d", inst->nrows);
                 else
@@ -172,50 +216,47 @@ void solve_sfixing(instance *inst){
             }
         }
         CPXgetobjval(inst->CPXenv, inst->CPXlp, &zbest);
-        if(zbest < inst->zbest){
+        enum lb_outcome outcome;
+        if(zbest < inst->zbest - EPSILON){
             print(inst, 'D', 1, "Found better solution value zbest = %f", zbest);
             inst->zbest = zbest;
-            inst->status = CPXgetstat(inst->CPXenv, inst->CPXlp);
-            k = min_k;
+            // optimal in the neighbourhood only
+            inst->status = (lpstat == CPXMIP_OPTIMAL || lpstat == CPXMIP_OPTIMAL_TOL) ? CPXMIP_TIME_LIM_FEAS : lpstat;
+            outcome = LB_IMPROVED;
 
             // swap array pointers
             double *temp = xbest;
             xbest = inst->xbest;
             inst->xbest = temp;
-        }else { // zbest == inst->zbest
-            k++;
-            nsol++;
-            print(inst, 'D', 1, "Increased k = %d", k);
-            if(k > max_k) {
-                // go back instead of wasting time!
-                k = min_k;
-
-                //print(inst, 'W', 1, "k exceeded limit");
-                //break;
-            }
-        }
+        }else if(lpstat == CPXMIP_OPTIMAL || lpstat == CPXMIP_OPTIMAL_TOL || lpstat == CPXMIP_INFEASIBLE)
+            outcome = LB_EXHAUSTED;
+        else // e.g. a solution limit on a solution of the same cost
+            outcome = LB_STOPPED;
         // plot
         //plot(inst, inst->xbest);
 
         if(!init) { // remove last constraint
+            bool more = lb_update(inst, &c, outcome, used);
             if (CPXdelrows(inst->CPXenv, inst->CPXlp, inst->nrows, inst->nrows))
                 printerr(inst, "Cannot delete row %d", inst->nrows);
             else
                 print(inst, 'D', 1, "Deleted row %d", inst->nrows);
+            if(!more){
+                print(inst, 'I', 1, "Local branching: the whole space is exhausted, zbest = %f is optimal", inst->zbest);
+                inst->status = CPXMIP_OPTIMAL;
+                break;
+            }
         }else {
             // unset initialization
             init = false;
-            nsol = 2;
-
-            if(inst->formulation == SFIXING1)
-                CPXsetlongparam(inst->CPXenv, CPXPARAM_MIP_Limits_Solutions, 9223372036800000000L);
         }
     }
     free(xbest);
+    free(varindices);
 
     // copy solution
     inst->xstar = (double *) calloc(inst->ncols, sizeof(double)); // TODO that's not "xstar"
     memcpy(inst->xstar, inst->xbest, inst->ncols * sizeof(double));
 
     inst->zstar = inst->zbest;
-}
\ No newline at end of file
+}
@@ -8,6 +8,22 @@
 #include "utils.h"
 #include "formulation_cuts.h"
 
+#define SFIX_NSTEPS 3       // k steps from min_k to max_k
+#define SFIX_SHRINK 0.75    // sub-MIP time limit reduction after a fast sub-MIP
+#define SFIX_GROW 1.5       // sub-MIP time limit increase after a stop in the smallest neighbourhood
+
+// outcome of a local branching sub-MIP: LB_STOPPED if it ended (time or solution limit) before proving anything
+enum lb_outcome {LB_IMPROVED, LB_EXHAUSTED, LB_STOPPED};
+
+// adaptive local branching controller: neighbourhood size and sub-MIP time limit
+typedef struct{
+    int k;                  // current neighbourhood size
+    int min_k, max_k, step;
+    int max_k0;             // max_k around a new solution (max_k grows when the neighbourhoods are exhausted)
+    double timelim;         // current sub-MIP time limit
+    double min_time, max_time;
+} lbcontrol;
+
 void build_model_sfixing(instance *);
 
 void get_solution_sfixing(instance *inst);
@@ -0,0 +1,401 @@
+//
+// Created by enrico on 17/07/21.
+//
+
+#include <sys/time.h>
+#include <float.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "formulation_spatial.h"
+#include "heuristics.h"
+#include "kdtree.h"
+
+// sub-MIP result of a window: nodes idx[wbeg[w], wbeg[w + 1]), at most one new edge per node
+typedef struct{
+    double delta;       // cost variation (< 0 for improvements)
+    int nedges;         // new internal edges, in edges[2 * wbeg[w], 2 * wbeg[w + 1])
+    bool optimal;       // the sub-MIP was solved to optimality
+} swresult;
+
+// a pass over a partition of the nodes into windows
+typedef struct{
+    instance *inst;
+    int *idx;           // nodes grouped by window
+    int *wbeg;          // first position of each window in idx
+    int *win;           // window of each node
+    int nwindows;
+    int *adj;           // incumbent tour: 2 neighbours per node (read only while the windows are solved)
+    int *edges;         // new internal edges (global ids)
+    swresult *res;
+    double timelim;     // sub-MIP time limit
+    _Atomic int next;   // next window to solve
+} swpass;
+
+// worker with its own CPLEX environment
+typedef struct{
+    swpass *pass;
+    CPXENVptr env;
+    int *local;         // local id of the window nodes, -1 for the other ones
+    double *x, *y;      // window points
+    int id;
+    pthread_t thread;
+} swworker;
+
+/**
+ * Split the nodes idx[lo, hi) into windows of at most SPATIAL_WINDOW nodes: each split is along the largest
+ * extent at a random rank between 40% and 60%, so that the window borders move from a pass to the next one.
+ *
+ * @return number of windows (their first positions are appended to wbeg)
+ */
+static int split_windows(instance *inst, int *idx, int lo, int hi, int *wbeg, int nw){
+    if(hi - lo <= SPATIAL_WINDOW){
+        wbeg[nw] = lo;
+        return nw + 1;
+    }
+    double xmin = DBL_MAX, xmax = -DBL_MAX, ymin = DBL_MAX, ymax = -DBL_MAX;
+    for(int p = lo; p < hi; p++){
+        double x = inst->xcoord[idx[p]], y = inst->ycoord[idx[p]];
+        if(x < xmin) xmin = x;
+        if(x > xmax) xmax = x;
+        if(y < ymin) ymin = y;
+        if(y > ymax) ymax = y;
+    }
+    int d = (ymax - ymin > xmax - xmin) ? 1 : 0;
+    int mid = lo + (int) ((long) (hi - lo) * (40 + rand() % 21) / 100);
+    kdtree_select(inst->xcoord, inst->ycoord, idx, lo, hi, mid, d);
+
+    nw = split_windows(inst, idx, lo, mid, wbeg, nw);
+    return split_windows(inst, idx, mid, hi, wbeg, nw);
+}
+
+/**
+ * Solve the sub-MIP of window w: its internal edges are free, the rest of the incumbent tour is fixed.
+ * Each path of the tour out of the window is contracted into an edge between its endpoints with cost 0
+ * and lower bound 1, so the sub-MIP is a TSP on the window nodes only.
+ *
+ * @param sw worker
+ * @param w window
+ */
+static void solve_window(swworker *sw, int w){
+    swpass *p = sw->pass;
+    instance *inst = p->inst;
+    swresult *res = &p->res[w];
+    const int *nodes = p->idx + p->wbeg[w];
+    int m = p->wbeg[w + 1] - p->wbeg[w];
+    res->delta = 0;
+    res->nedges = 0;
+    res->optimal = false;
+    if(m < 5) return;
+
+    // sub-instance on the window points: same distance function
+    instance sub = *inst;
+    for(int a = 0; a < m; a++){
+        sw->local[nodes[a]] = a;
+        sw->x[a] = inst->xcoord[nodes[a]];
+        sw->y[a] = inst->ycoord[nodes[a]];
+    }
+    sub.nnodes = m;
+    sub.xcoord = sw->x;
+    sub.ycoord = sw->y;
+    sub.verbose = 0;
+    sub.sparse = false;
+    sub.edges = NULL;
+    sub.cbdata = NULL;
+    sub.cand = NULL;
+    sub.ncand = 0;
+    sub.elite = NULL;
+    sub.succ = NULL;
+    sub.xbest = sub.xstar = NULL;
+    sub.opt_tour = NULL;
+    sub.CPXenv = sw->env;
+    int err;
+    sub.CPXlp = CPXcreateprob(sw->env, &err, "window");
+    if(err) printerr(inst, "Can't create the LP problem of window %d", w);
+    build_model_base_undirected(&sub);
+    sub.ncols = CPXgetnumcols(sub.CPXenv, sub.CPXlp);
+    install_cuts_callback(&sub, 1);
+
+    // incumbent restricted to the window: internal edges and contracted paths
+    double *obj = (double *) malloc(sub.ncols * sizeof(double));
+    double *xstart = (double *) calloc(sub.ncols, sizeof(double));
+    bool *fixed = (bool *) calloc(sub.ncols, sizeof(bool));
+    int *contracted = (int *) malloc(m * sizeof(int));
+    int ncontracted = 0;
+    double zold = 0;
+    for(int a = 0, k = 0; a < m; a++)
+        for(int b = a + 1; b < m; b++, k++)
+            obj[k] = cost(a, b, &sub);
+    for(int a = 0; a < m; a++){
+        int i = nodes[a];
+        for(int s = 0; s < 2; s++){
+            int prev = i, curr = p->adj[2 * i + s];
+            if(sw->local[curr] >= 0){
+                if(a < sw->local[curr]){
+                    xstart[xpos_undirected(a, sw->local[curr], &sub)] = 1;
+                    zold += obj[xpos_undirected(a, sw->local[curr], &sub)];
+                }
+                continue;
+            }
+            // walk the path out of the window
+            while(sw->local[curr] < 0){
+                int next = (p->adj[2 * curr] != prev) ? p->adj[2 * curr] : p->adj[2 * curr + 1];
+                prev = curr;
+                curr = next;
+            }
+            if(a < sw->local[curr]){
+                int k = xpos_undirected(a, sw->local[curr], &sub);
+                contracted[ncontracted++] = k;
+                fixed[k] = true;
+                obj[k] = 0;
+                xstart[k] = 1;
+            }
+        }
+    }
+
+    // fix the contracted paths
+    if(ncontracted > 0){
+        char *lu = (char *) malloc(ncontracted * sizeof(char));
+        double *bd = (double *) malloc(ncontracted * sizeof(double));
+        double *zero = (double *) calloc(ncontracted, sizeof(double));
+        for(int c = 0; c < ncontracted; c++){
+            lu[c] = 'L';
+            bd[c] = 1;
+        }
+        if(CPXchgbds(sub.CPXenv, sub.CPXlp, ncontracted, contracted, lu, bd) ||
+           CPXchgobj(sub.CPXenv, sub.CPXlp, ncontracted, contracted, zero))
+            printerr(inst, "Can't fix the contracted paths of window %d", w);
+        free(lu);
+        free(bd);
+        free(zero);
+    }
+    ((cutsdata *) sub.cbdata)->obj = obj;
+
+    // start from the incumbent
+    int *varindices = (int *) malloc(sub.ncols * sizeof(int));
+    for(int k = 0; k < sub.ncols; k++) varindices[k] = k;
+    int beg[] = {0};
+    int effort[] = {CPX_MIPSTART_AUTO};
+    if(CPXaddmipstarts(sub.CPXenv, sub.CPXlp, 1, sub.ncols, beg, varindices, xstart, effort, NULL))
+        print(inst, 'W', 1, "Can't add warm start of window %d", w);
+
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    double elapsed = (double) (now.tv_sec - inst->tstart.tv_sec);
+    double left = inst->time_limit - elapsed;
+    CPXsetdblparam(sub.CPXenv, CPXPARAM_TimeLimit, (left < p->timelim) ? ((left > 0) ? left : 0) : p->timelim);
+    CPXsetintparam(sub.CPXenv, CPXPARAM_RandomSeed, (inst->seed + w) & 0x7fffffff);
+
+    double znew;
+    double *x = xstart;
+    if(!CPXmipopt(sub.CPXenv, sub.CPXlp) && !CPXgetx(sub.CPXenv, sub.CPXlp, x, 0, sub.ncols - 1) &&
+       !CPXgetobjval(sub.CPXenv, sub.CPXlp, &znew)){
+        int stat = CPXgetstat(sub.CPXenv, sub.CPXlp);
+        res->optimal = (stat == CPXMIP_OPTIMAL || stat == CPXMIP_OPTIMAL_TOL);
+        if(znew < zold - EPSILON){
+            // new internal edges
+            int *e = p->edges + 2 * p->wbeg[w];
+            for(int a = 0, k = 0; a < m; a++)
+                for(int b = a + 1; b < m; b++, k++)
+                    if(x[k] > 0.5 && !fixed[k]){
+                        e[2 * res->nedges] = nodes[a];
+                        e[2 * res->nedges + 1] = nodes[b];
+                        res->nedges++;
+                    }
+            res->delta = znew - zold;
+        }
+    }
+
+    for(int a = 0; a < m; a++) sw->local[nodes[a]] = -1;
+    free_cutsdata(sub.cbdata);
+    free(sub.cand);
+    CPXfreeprob(sub.CPXenv, &sub.CPXlp);
+    free(obj);
+    free(xstart);
+    free(fixed);
+    free(contracted);
+    free(varindices);
+}
+
+static void * swworker_run(void *arg){
+    swworker *sw = (swworker *) arg;
+    swpass *p = sw->pass;
+    while(!timeout(p->inst)){
+        int w = atomic_fetch_add(&p->next, 1);
+        if(w >= p->nwindows) break;
+        solve_window(sw, w);
+    }
+    return NULL;
+}
+
+// replace the internal edges of window w with the given ones
+static void set_internal(swpass *p, int w, const int *edges, int nedges){
+    for(int q = p->wbeg[w]; q < p->wbeg[w + 1]; q++){
+        int i = p->idx[q];
+        for(int s = 0; s < 2; s++)
+            if(p->adj[2 * i + s] >= 0 && p->win[p->adj[2 * i + s]] == w) p->adj[2 * i + s] = -1;
+    }
+    for(int e = 0; e < nedges; e++){
+        int i = edges[2 * e], j = edges[2 * e + 1];
+        p->adj[2 * i + ((p->adj[2 * i] < 0) ? 0 : 1)] = j;
+        p->adj[2 * j + ((p->adj[2 * j] < 0) ? 0 : 1)] = i;
+    }
+}
+
+// true iff adj is a Hamiltonian cycle
+static bool is_tour(swpass *p){
+    int n = p->inst->nnodes;
+    int prev = 0, curr = p->adj[0], len = 1;
+    while(curr != 0 && curr >= 0 && len <= n){
+        int next = (p->adj[2 * curr] != prev) ? p->adj[2 * curr] : p->adj[2 * curr + 1];
+        prev = curr;
+        curr = next;
+        len++;
+    }
+    return curr == 0 && len == n;
+}
+
+/**
+ * Merge the improved windows into the incumbent, one at a time: the contracted paths of a window
+ * were computed on the tour at the beginning of the pass, so after the merge of other windows
+ * its new edges may close subtours; in that case they are discarded.
+ *
+ * @return number of merged windows
+ */
+static int merge_windows(swpass *p, double *zbest){
+    int *old = (int *) malloc(2 * (SPATIAL_WINDOW + 1) * sizeof(int));
+    int merged = 0;
+    for(int w = 0; w < p->nwindows; w++){
+        swresult *res = &p->res[w];
+        if(res->delta > -EPSILON) continue;
+
+        // current internal edges
+        int nold = 0;
+        for(int q = p->wbeg[w]; q < p->wbeg[w + 1]; q++){
+            int i = p->idx[q];
+            for(int s = 0; s < 2; s++){
+                int j = p->adj[2 * i + s];
+                if(p->win[j] == w && i < j){
+                    old[2 * nold] = i;
+                    old[2 * nold++ + 1] = j;
+                }
+            }
+        }
+
+        set_internal(p, w, p->edges + 2 * p->wbeg[w], res->nedges);
+        if(is_tour(p)){
+            *zbest += res->delta;
+            merged++;
+        }else
+            set_internal(p, w, old, nold);
+    }
+    free(old);
+    return merged;
+}
+
+/**
+ * Spatial-window fix-and-optimize: at each pass the nodes are split into windows of at most
+ * SPATIAL_WINDOW close nodes (random 2-d tree cuts), then all the windows are solved in parallel:
+ * the edges with both endpoints in the window are free and the rest of the incumbent is fixed.
+ * The improvements are merged at the end of the pass.
+ * No model of the whole graph is built, so the sub-MIPs keep the same size on large instances.
+ *
+ * @param inst general instance
+ */
+void solve_spatialfix(instance *inst){
+    int n = inst->nnodes;
+
+    // starting tour
+    warm_start(inst, GREEDY);
+    inst->directed = false;
+    inst->status = CPXMIP_TIME_LIM_FEAS;
+
+    swpass p;
+    p.inst = inst;
+    p.idx = (int *) malloc(n * sizeof(int));
+    p.wbeg = (int *) malloc((n + 1) * sizeof(int));
+    p.win = (int *) malloc(n * sizeof(int));
+    p.adj = (int *) malloc(2 * n * sizeof(int));
+    p.edges = (int *) malloc(2 * n * sizeof(int));
+    p.res = (swresult *) malloc(n * sizeof(swresult));
+    p.timelim = SPATIAL_TIMELIM;
+    for(int i = 0; i < n; i++){
+        p.idx[i] = i;
+        p.adj[2 * i] = inst->succ[i];
+        p.adj[2 * inst->succ[i] + 1] = i;
+    }
+
+    // workers
+    int nworkers = ncores();
+    swworker *workers = (swworker *) calloc(nworkers, sizeof(swworker));
+    for(int k = 0; k < nworkers; k++){
+        swworker *sw = &workers[k];
+        sw->pass = &p;
+        sw->id = k;
+        int err;
+        sw->env = CPXopenCPLEX(&err);
+        if(err) printerr(inst, "Can't create CPLEX environment of worker %d", k);
+        CPXsetdblparam(sw->env, CPXPARAM_MIP_Limits_TreeMemory, inst->mem_limit);
+        sw->local = (int *) malloc(n * sizeof(int));
+        for(int i = 0; i < n; i++) sw->local[i] = -1;
+        sw->x = (double *) malloc(SPATIAL_WINDOW * sizeof(double));
+        sw->y = (double *) malloc(SPATIAL_WINDOW * sizeof(double));
+    }
+
+    int idle = 0;
+    for(int pass = 0; !timeout(inst) && idle < SPATIAL_MAXIDLE; pass++){
+        // new partition
+        p.nwindows = split_windows(inst, p.idx, 0, n, p.wbeg, 0);
+        p.wbeg[p.nwindows] = n;
+        for(int w = 0; w < p.nwindows; w++)
+            for(int q = p.wbeg[w]; q < p.wbeg[w + 1]; q++)
+                p.win[p.idx[q]] = w;
+        // the windows left unsolved at the time limit must not be merged
+        for(int w = 0; w < p.nwindows; w++){
+            p.res[w].delta = 0;
+            p.res[w].nedges = 0;
+            p.res[w].optimal = false;
+        }
+        atomic_init(&p.next, 0);
+
+        for(int k = 0; k < nworkers; k++)
+            if(pthread_create(&workers[k].thread, NULL, swworker_run, &workers[k]))
+                printerr(inst, "Cannot create spatial-fixing worker %d", k);
+        for(int k = 0; k < nworkers; k++)
+            pthread_join(workers[k].thread, NULL);
+
+        int merged = merge_windows(&p, &inst->zbest);
+        idle = merged ? 0 : idle + 1;
+        print(inst, 'D', 1, "Spatial fixing: pass %d, %d windows, %d merged, zbest = %f",
+              pass, p.nwindows, merged, inst->zbest);
+
+        // a single window is the whole problem
+        if(p.nwindows == 1 && p.res[0].optimal){
+            inst->status = CPXMIP_OPTIMAL;
+            break;
+        }
+    }
+
+    // successors from the adjacency lists
+    for(int prev = p.adj[1], curr = 0, k = 0; k < n; k++){
+        int next = (p.adj[2 * curr] != prev) ? p.adj[2 * curr] : p.adj[2 * curr + 1];
+        inst->succ[curr] = next;
+        prev = curr;
+        curr = next;
+    }
+    inst->zbest = cost_succ(inst, inst->succ);
+    inst->zstar = inst->zbest;
+
+    for(int k = 0; k < nworkers; k++){
+        CPXcloseCPLEX(&workers[k].env);
+        free(workers[k].local);
+        free(workers[k].x);
+        free(workers[k].y);
+    }
+    free(workers);
+    free(p.idx);
+    free(p.wbeg);
+    free(p.win);
+    free(p.adj);
+    free(p.edges);
+    free(p.res);
+}
@@ -0,0 +1,17 @@
+//
+// Created by enrico on 17/07/21.
+//
+
+#ifndef TSP_OP2_FORMULATION_SPATIAL_H
+#define TSP_OP2_FORMULATION_SPATIAL_H
+
+#include "utils.h"
+#include "formulation_cuts.h"
+
+#define SPATIAL_WINDOW 100      // max number of nodes of a window
+#define SPATIAL_TIMELIM 10.0    // time limit of a window sub-MIP (seconds)
+#define SPATIAL_MAXIDLE 5       // stop after this number of passes without improvement
+
+void solve_spatialfix(instance *inst);
+
+#endif //TSP_OP2_FORMULATION_SPATIAL_H
@@ -0,0 +1,107 @@
+//
+// Created by enrico on 02/07/21.
+//
+
+#include <stdlib.h>
+#include "heap.h"
+
+heap * new_heap(int cap){
+    heap *h = malloc(sizeof(heap));
+    h->cap = cap;
+    h->len = 0;
+    h->item = malloc(cap * sizeof(int));
+    h->pos = malloc(cap * sizeof(int));
+    h->key = malloc(cap * sizeof(double));
+    for(int i = 0; i < cap; i++) h->pos[i] = -1;
+    return h;
+}
+
+void free_heap(heap *h){
+    if(h == NULL) return;
+    free(h->item);
+    free(h->pos);
+    free(h->key);
+    free(h);
+}
+
+bool heap_empty(const heap *h){
+    return h->len == 0;
+}
+
+bool heap_contains(const heap *h, int i){
+    return h->pos[i] >= 0;
+}
+
+double heap_key(const heap *h, int i){
+    return h->key[i];
+}
+
+// item with minimum key, -1 if empty
+int heap_top(const heap *h){
+    return (h->len > 0) ? h->item[0] : -1;
+}
+
+static void place(heap *h, int p, int i){
+    h->item[p] = i;
+    h->pos[i] = p;
+}
+
+static void sift_up(heap *h, int p){
+    int i = h->item[p];
+    while(p > 0){
+        int parent = (p - 1) / 2;
+        if(h->key[h->item[parent]] <= h->key[i]) break;
+        place(h, p, h->item[parent]);
+        p = parent;
+    }
+    place(h, p, i);
+}
+
+static void sift_down(heap *h, int p){
+    int i = h->item[p];
+    while(2 * p + 1 < h->len){
+        int child = 2 * p + 1;
+        if(child + 1 < h->len && h->key[h->item[child + 1]] < h->key[h->item[child]]) child++;
+        if(h->key[i] <= h->key[h->item[child]]) break;
+        place(h, p, h->item[child]);
+        p = child;
+    }
+    place(h, p, i);
+}
+
+/**
+ * Insert item i, or change its key if it's already in the heap. O(log n)
+ */
+void heap_push(heap *h, int i, double key){
+    if(h->pos[i] < 0){
+        h->key[i] = key;
+        place(h, h->len++, i);
+        sift_up(h, h->pos[i]);
+        return;
+    }
+    double old = h->key[i];
+    h->key[i] = key;
+    if(key < old) sift_up(h, h->pos[i]);
+    else sift_down(h, h->pos[i]);
+}
+
+// remove item i from the heap (if present). O(log n)
+void heap_remove(heap *h, int i){
+    int p = h->pos[i];
+    if(p < 0) return;
+    h->pos[i] = -1;
+    if(--h->len == p) return;
+
+    // move the last item in the hole
+    int last = h->item[h->len];
+    place(h, p, last);
+    sift_up(h, p);
+    sift_down(h, h->pos[last]);
+}
+
+// remove and return the item with minimum key, -1 if empty. O(log n)
+int heap_pop(heap *h){
+    int i = heap_top(h);
+    if(i >= 0) heap_remove(h, i);
+    return i;
+}
@@ -0,0 +1,36 @@
+//
+// Created by enrico on 02/07/21.
+//
+
+#ifndef TSP_OP2_HEAP_H
+#define TSP_OP2_HEAP_H
+
+#include <stdbool.h>
+
+// indexed binary min-heap on items 0, ..., cap - 1
+typedef struct{
+    int cap, len;
+    int *item;      // item[p] = item at heap position p
+    int *pos;       // pos[i] = heap position of item i, -1 if not in the heap
+    double *key;    // key[i] = priority of item i
+} heap;
+
+heap * new_heap(int cap);
+
+void free_heap(heap *h);
+
+bool heap_empty(const heap *h);
+
+bool heap_contains(const heap *h, int i);
+
+double heap_key(const heap *h, int i);
+
+int heap_top(const heap *h);
+
+void heap_push(heap *h, int i, double key);
+
+int heap_pop(heap *h);
+
+void heap_remove(heap *h, int i);
+
+#endif //TSP_OP2_HEAP_H
@@ -5,93 +5,206 @@
 #include <float.h>
 #include "heuristic_VNS.h"
 #include "heuristic_kopt.h"
+#include "distances.h"
+#include "candidates.h"
 
-void reord(instance *inst, int *succ, int *a, int *b, int *c){
-    int curr = succ[*a];
-    int count = inst->nnodes;
-    while(curr != *a){
-        if(curr == *b) break; // already ordered
-        if(curr == *c){
-            // swap & break
-            int t = *c;
-            *c = *b;
-            *b = t;
-            break;
-        }
-        // update curr
-        curr = succ[curr];
-
-        if(count == 0) printerr(inst, "Error finding 3 chains!");
-        count--;
-    }
+// node at (cyclic) position p
+static int at(const tour *t, int p){
+    return t->node[p % t->nnodes];
 }
 
-void kick(instance *inst, int *succ, int k){
-    // define random nodes
-    int a, b, c, d;
-    switch(k){
-        case 3:
-            // choose 1st node
-            a = rand() % inst->nnodes;
-
-            // choose 2nd node
-            do{b = rand() % inst->nnodes;}while(b == a);
-
-            // choose 3rd node
-            do{c = rand() % inst->nnodes;}while((c == a) || (c == b));
+// activate node i and its candidates for the next local search
+static void activate(instance *inst, nodequeue *q, int i){
+    if(q == NULL) return;
+    push_node(q, i);
+    for(int k = 0; k < inst->ncand; k++)
+        push_node(q, inst->cand[i * inst->ncand + k]);
+}
 
-            // reorder based on successors
-            reord(inst, succ, &a, &b, &c);
+/**
+ * Rearrange the three consecutive segments B = (p, p + l1], C = (p + l1, p + l1 + l2] of a tour A B C D.
+ * Only the positions of B and C are rewritten, so it costs O(l1 + l2).
+ *
+ * @param inst instance pointer
+ * @param t tour to perturb
+ * @param p position of the last node of A
+ * @param l1 length of B
+ * @param l2 length of C
+ * @param reverse true for A rev(C) B D (3-opt kick), false for A C B D (double bridge)
+ * @param q returned endpoints of the changed edges (can be NULL)
+ * @param buf scratch array of size nnodes
+ * @return cost variation
+ */
+static double rearrange(instance *inst, tour *t, int p, int l1, int l2, bool reverse, nodequeue *q, int *buf){
+    int a = at(t, p), b1 = at(t, p + 1), b2 = at(t, p + l1);
+    int c1 = at(t, p + l1 + 1), c2 = at(t, p + l1 + l2), d = at(t, p + l1 + l2 + 1);
+
+    // removed edges
+    double delta = - cost(a, b1, inst) - cost(b2, c1, inst) - cost(c2, d, inst);
+    // added edges
+    if(reverse)
+        delta += cost(a, c2, inst) + cost(c1, b1, inst) + cost(b2, d, inst);
+    else
+        delta += cost(a, c1, inst) + cost(c2, b1, inst) + cost(b2, d, inst);
+
+    // copy C then B
+    int k = 0;
+    for(int i = 0; i < l2; i++)
+        buf[k++] = reverse ? at(t, p + l1 + l2 - i) : at(t, p + l1 + 1 + i);
+    for(int i = 0; i < l1; i++)
+        buf[k++] = at(t, p + 1 + i);
+
+    // write them back updating the position index
+    tour_write(t, (p + 1) % t->nnodes, buf, k);
+
+    activate(inst, q, a);
+    activate(inst, q, b1);
+    activate(inst, q, b2);
+    activate(inst, q, c1);
+    activate(inst, q, c2);
+    activate(inst, q, d);
+    return delta;
+}
 
-            // find successors
-            int aprime = succ[a];
-            int bprime = succ[b];
-            int cprime = succ[c];
+/**
+ * Perturb the tour
+ * k = 3: choose 3 random nodes a, b, c and reconnect a -> c, b' -> a', b -> c' (reversing b'...c)
+ * k = 4: segment-based double bridge, i.e. swap two adjacent segments of at most VNS_SEGLEN nodes
+ *
+ * @param inst instance pointer
+ * @param t tour to perturb
+ * @param k kick type
+ * @param q returned endpoints of the changed edges (can be NULL)
+ * @param buf scratch array of size nnodes
+ * @param seed private RNG state (NULL for rand())
+ * @return cost variation
+ */
+double kick(instance *inst, tour *t, int k, nodequeue *q, int *buf, unsigned int *seed){
+    int n = t->nnodes;
+    if(n < 5) return 0; // nothing to perturb
 
-            // reverse chain
-            reverse_chain(succ, bprime, c);
+    switch(k){
+        case 3: {
+            int p1, p2, p3;
+            do{
+                // choose 3 random positions...
+                p1 = rand_s(seed) % n;
+                do{p2 = rand_s(seed) % n;}while(p2 == p1);
+                do{p3 = rand_s(seed) % n;}while((p3 == p1) || (p3 == p2));
+
+                // ...and sort them: no need to walk the tour
+                int t1;
+                if(p1 > p2){ t1 = p1; p1 = p2; p2 = t1; }
+                if(p2 > p3){ t1 = p2; p2 = p3; p3 = t1; }
+                if(p1 > p2){ t1 = p1; p1 = p2; p2 = t1; }
+            }while(p3 - p1 > n - 2); // c' must differ from a
+
+            return rearrange(inst, t, p1, p2 - p1, p3 - p2, true, q, buf);
+        }
+        case 4: {
+            int maxlen = (n - 2) / 2;
+            if(maxlen > VNS_SEGLEN) maxlen = VNS_SEGLEN;
+            int l1 = 1 + rand_s(seed) % maxlen;
+            int l2 = 1 + rand_s(seed) % maxlen;
 
-            // reconnect chains
-            succ[a] = c;
-            succ[bprime] = aprime;
-            succ[b] = cprime;
-            break;
-        case 4: // TODO k = 4?
+            return rearrange(inst, t, rand_s(seed) % n, l1, l2, false, q, buf);
+        }
         default:
             printerr(inst,"kick(): k = %d not implemented", k);
     }
 }
 
-double VNS(instance *inst){
-    // build a temporary solution vector (successors)
-    int *sol = calloc(inst->nnodes, sizeof(int));
+/**
+ * Random restart of a tour segment: shuffle len consecutive nodes.
+ *
+ * @param inst instance pointer
+ * @param t tour to perturb
+ * @param len segment length
+ * @param q returned endpoints of the changed edges (can be NULL)
+ * @param buf scratch array of size nnodes
+ * @param seed private RNG state (NULL for rand())
+ * @return cost variation
+ */
+double segment_restart(instance *inst, tour *t, int len, nodequeue *q, int *buf, unsigned int *seed){
+    int n = t->nnodes;
+    if(len > n - 2) len = n - 2;
+    if(len < 2) return 0;
+
+    int p = rand_s(seed) % n;
+
+    // cost of the old path from at(p) to at(p + len + 1)
+    double delta = 0;
+    for(int i = 0; i <= len; i++)
+        delta -= cost(at(t, p + i), at(t, p + i + 1), inst);
+
+    // Fisher-Yates shuffle of the segment
+    for(int i = 0; i < len; i++)
+        buf[i] = at(t, p + 1 + i);
+    for(int i = len - 1; i > 0; i--){
+        int r = rand_s(seed) % (i + 1);
+        int tmp = buf[i];
+        buf[i] = buf[r];
+        buf[r] = tmp;
+    }
+    tour_write(t, (p + 1) % n, buf, len);
+
+    // cost of the new path
+    for(int i = 0; i <= len; i++)
+        delta += cost(at(t, p + i), at(t, p + i + 1), inst);
 
-    double zbest = DBL_MAX;
+    for(int i = 0; i <= len + 1; i++)
+        activate(inst, q, at(t, p + i));
+
+    return delta;
+}
+
+double VNS(instance *inst, unsigned int *seed){
+    tour *t = new_tour(inst->nnodes);
+    succtotour(inst, inst->succ, t);
+    int *buf = calloc(inst->nnodes, sizeof(int));
+    nodequeue *q = new_nodequeue(inst->nnodes);
+    candidates(inst);
 
     bool findmin = true;
 
+    // current neighbourhood: number of double bridges in the kick
+    int k = 1;
+
     switch(inst->ref_heuristic){
-        case VNS1: // two-opt(-min) and jump on three-opt neighbourhood
+        case VNS1: // two-opt(-min) and jump on double bridge neighbourhoods
             findmin = false;
         case VNS2:
-            while(!timeout(inst)){
-                // copy best solution
-                memcpy(sol, inst->succ, inst->nnodes * sizeof(int));
+            // start from a local optimum
+            for(int i = 0; i < inst->nnodes; i++)
+                push_node(q, i);
+            two_opt_local(inst, t, q, findmin);
+            double zbest = cost_tour(inst, t);
 
-                // perturb it
-                kick(inst, sol, 3);
-
-                // find local optimum in 2-opt neighborhood
-                double z = two_opt(inst, sol, findmin);
-
-                // update minimum
-                if(z < zbest){
-                    zbest = z;
-
-                    // swap vectors
-                    int *t = sol;
-                    sol = inst->succ;
-                    inst->succ = t;
+            while(!timeout(inst)){
+                // record changes to the best solution
+                tour_mark(t);
+
+                // perturb it: the longer we stall the stronger the kick
+                double delta = 0;
+                if(k > VNS_KMAX) {
+                    delta += segment_restart(inst, t, VNS_RESTART, q, buf, seed);
+                    k = 1;
+                }else
+                    for(int i = 0; i < k; i++)
+                        delta += kick(inst, t, 4, q, buf, seed);
+
+                // find local optimum in 2-opt neighborhood, starting from the kicked nodes only
+                delta += two_opt_local(inst, t, q, findmin);
+
+                // update minimum or undo the changes and move to a larger neighbourhood
+                if(delta < -EPSILON){
+                    tour_commit(t);
+                    zbest += delta;
+                    print(inst, 'D', 2, "VNS: zbest = %f (k = %d)", zbest, k);
+                    k = 1;
+                }else{
+                    tour_rollback(t);
+                    k++;
                 }
             }
             break;
@@ -99,6 +212,10 @@ double VNS(instance *inst){
             printerr(inst, "VNS(): heuristic not implemented");
     }
 
-    free(sol);
-    return zbest;
-}
\ No newline at end of file
+    tourtosucc(t, inst->succ);
+
+    free(buf);
+    free_nodequeue(q);
+    free_tour(t);
+    return cost_succ(inst, inst->succ);
+}
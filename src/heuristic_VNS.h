@@ -3,12 +3,20 @@
 //
 
 #include "utils.h"
+#include "tour.h"
+#include "heuristic_kopt.h"
 
 #ifndef TSP_OP2_HEURISTIC_VNS_H
 #define TSP_OP2_HEURISTIC_VNS_H
 
-void kick(instance *inst, int *succ, int k);
+#define VNS_KMAX 10     // max number of double bridges in a kick
+#define VNS_SEGLEN 50   // max segment length of a double bridge
+#define VNS_RESTART 100 // segment length of a random restart
 
-double VNS(instance *inst);
+double kick(instance *inst, tour *t, int k, nodequeue *q, int *buf, unsigned int *seed);
+
+double segment_restart(instance *inst, tour *t, int len, nodequeue *q, int *buf, unsigned int *seed);
+
+double VNS(instance *inst, unsigned int *seed);
 
 #endif //TSP_OP2_HEURISTIC_VNS_H
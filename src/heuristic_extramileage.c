@@ -4,6 +4,8 @@
 #include "formulation_commons.h"
 #include "graham_scan.h"
 #include "plot.h"
+#include "heap.h"
+#include "candidates.h"
 //
 // Created by enrico on 08/05/21.
 //
@@ -30,124 +32,316 @@ PointSet * insttopointset(instance *inst){
  * Select a convex hull using the library https://github.com/jwlodek/Graham-Scan
  * @param inst instance pointer
  * @param visited array of visited nodes
+ * @param succ returned (partial) tour on the hull
+ * @param hull returned hull nodes (can be NULL)
+ * @return number of hull nodes
  */
-int selecthull(instance *inst, bool *visited){
+int selecthull(instance *inst, bool *visited, int *succ, int *hull){
     PointSet *ps = insttopointset(inst);
-    PointSet *sol = remove_degeneracy(compute_convex_hull(ps));
+    PointSet *ch = compute_convex_hull(ps);
+    PointSet *sol = remove_degeneracy(ch);
 
-    for(int i = 0; i < sol->num_points - 1; i++){
+    for(int i = 0; i < sol->num_points; i++){
         int a = sol->points[i].id;
-        int b = sol->points[i + 1].id;
-        //printf("a = %d, b = %d\n", a + 1, b + 1);
-        printf("p%d = (%f,%f)\n", a+1, sol->points[i].xCoord, sol->points[i].yCoord);
-        inst->xbest[xpos_directed(a, b, inst)] = 1;
+        int b = sol->points[(i + 1) % sol->num_points].id; // close the circuit
+        print(inst, 'D', 3, "p%d = (%f,%f)", a + 1, sol->points[i].xCoord, sol->points[i].yCoord);
+        succ[a] = b;
         visited[a] = true;
+        if(hull != NULL) hull[i] = a;
     }
+    int nhull = sol->num_points;
 
-    // close the circuit
-    int a = sol->points[sol->num_points - 1].id;
-    int b = sol->points[0].id;
-    //printf("a = %d, b = %d\n", a + 1, b + 1);
-    printf("p%d = (%f,%f)\n", a+1, sol->points[sol->num_points-1].xCoord, sol->points[sol->num_points-1].yCoord);
-    visited[a] = true;
-    inst->xbest[xpos_directed(a, b, inst)] = 1;
-
-    printf("Hull selected!\n");
-    if(inst->verbose >= 3)
-        plot(inst, inst->xbest);
-    return sol->num_points;
+    free(ps->points);
+    free(ps);
+    free(ch->points);
+    free(ch);
+    free(sol->points);
+    free(sol);
+
+    print(inst, 'D', 2, "Hull selected: %d nodes", nhull);
+    return nhull;
 }
 
+/**
+ * Set diameter: the farthest pair of points is on the convex hull, so only hull nodes are compared
+ */
 double diameter(instance *inst, int *a, int *b){
-    double d = 0;
-    for(int i = 0; i < inst->nnodes; i++){
-        for(int j = i + 1; j < inst->nnodes; j++){
-            //printf("cost(%d,%d) = ", i+1, j+1);
-            double c = cost(i, j, inst);
-            //printf("%f\n", c);
+    bool *visited = calloc(inst->nnodes, sizeof(bool));
+    int *succ = malloc(inst->nnodes * sizeof(int));
+    int *hull = malloc(inst->nnodes * sizeof(int));
+    int nhull = selecthull(inst, visited, succ, hull);
+
+    double d = -1;
+    for(int p = 0; p < nhull; p++){
+        for(int q = p + 1; q < nhull; q++){
+            double c = cost(hull[p], hull[q], inst);
             if(c > d){
                 d = c;
-                *a = i;
-                *b = j;
+                *a = hull[p];
+                *b = hull[q];
             }
         }
     }
+
+    free(visited);
+    free(succ);
+    free(hull);
     return d;
 }
 
-int init_extramileage(instance *inst, bool *visited){
+int init_extramileage(instance *inst, bool *visited, int *succ){
     if(inst->cons_heuristic == EXTRAMILEAGE) { // find set diameter
         int a, b;
         diameter(inst, &a, &b);
         visited[a] = visited[b] = true;
 
         // select (a,b) and (b,a) edges
-        inst->xbest[xpos_directed(a, b, inst)] = 1;
-        inst->xbest[xpos_directed(b, a, inst)] = 1;
-        if(inst->verbose >= 3)
-            plot(inst, inst->xbest);
-
+        succ[a] = b;
+        succ[b] = a;
         return 2;
     }else // find convex hull
-        return selecthull(inst, visited);
+        return selecthull(inst, visited, succ, NULL);
+}
+
+// best insertion edge of a not visited node
+typedef struct{
+    int from;       // the node is inserted between from and succ[from]
+    double delta;   // extra-mileage
+    int near;       // nearest visited node
+    double dist;    // its squared euclidean distance
+} insertion;
+
+// state of the insertion heuristic
+typedef struct{
+    instance *inst;
+    int *succ, *pred;       // partial tour
+    bool *visited;
+    insertion *ins;
+    int *whead, *wnext, *wprev; // watchers: lists of the nodes u with ins[u].from == v
+    int *rfirst, *ritem;        // reverse candidate lists: u such that v is a candidate of u
+} engine;
+
+static double extra(instance *inst, int i, int j, int h){
+    return cost(i, h, inst) + cost(h, j, inst) - cost(i, j, inst);
+}
+
+static double dist2(instance *inst, int i, int j){
+    double dx = inst->xcoord[i] - inst->xcoord[j], dy = inst->ycoord[i] - inst->ycoord[j];
+    return dx * dx + dy * dy;
+}
+
+static void unwatch(engine *g, int u){
+    int v = g->ins[u].from;
+    if(v < 0) return;
+    if(g->wprev[u] >= 0) g->wnext[g->wprev[u]] = g->wnext[u];
+    else g->whead[v] = g->wnext[u];
+    if(g->wnext[u] >= 0) g->wprev[g->wnext[u]] = g->wprev[u];
+    g->ins[u].from = -1;
+}
+
+static void set_from(engine *g, int u, int v){
+    if(g->ins[u].from == v) return;
+    unwatch(g, u);
+    g->ins[u].from = v;
+    g->wprev[u] = -1;
+    g->wnext[u] = g->whead[v];
+    if(g->whead[v] >= 0) g->wprev[g->whead[v]] = u;
+    g->whead[v] = u;
+}
+
+// try the two tour edges of the visited node v as insertion edges of h
+static void try_edges(engine *g, int v, int h){
+    insertion *e = &g->ins[h];
+    double d1 = extra(g->inst, g->pred[v], v, h), d2 = extra(g->inst, v, g->succ[v], h);
+    if(d1 < e->delta){
+        e->delta = d1;
+        set_from(g, h, g->pred[v]);
+    }
+    if(d2 < e->delta){
+        e->delta = d2;
+        set_from(g, h, v);
+    }
+}
+
+// cheapest insertion edge of h among the ones near its nearest visited node or touching its visited candidates
+static void best_insertion(engine *g, int h){
+    instance *inst = g->inst;
+    unwatch(g, h);
+    g->ins[h].delta = DBL_MAX;
+    int v = g->ins[h].near;
+    try_edges(g, v, h);
+    try_edges(g, g->pred[v], h);
+    try_edges(g, g->succ[v], h);
+    for(int k = 0; k < inst->ncand; k++){
+        int v = inst->cand[h * inst->ncand + k];
+        if(g->visited[v]) try_edges(g, v, h);
+    }
 }
 
+// priority of a not visited node (lower is first) according to the insertion policy
+static double priority(instance *inst, const insertion *ins){
+    switch(inst->insertion){
+        case NEAREST:
+            return ins->dist;
+        case FARTHEST:
+            return -ins->dist;
+        case CHEAPEST:
+        default:
+            return ins->delta;
+    }
+}
+
+static void update_key(engine *g, heap *queue, int u){
+    // random keys never change
+    if(g->inst->insertion == RANDOM) return;
+    double key = priority(g->inst, &g->ins[u]);
+    if(key != heap_key(queue, u)) heap_push(queue, u, key);
+}
+
+/**
+ * Insertion heuristic starting from the set diameter (EXTRAMILEAGE) or the convex hull (EXTRAMILEAGECONVEXHULL).
+ * The node to insert is chosen by the --insertion policy (cheapest, nearest, farthest or random) and is put
+ * in its cheapest position.
+ * Every not visited node keeps in a priority queue its distance from the tour and its cheapest insertion edge
+ * among the ones touching its nearest visited node or its visited candidates. After each insertion only the
+ * affected entries are updated: the nodes whose best edge was removed (kept in per-edge lists), the nodes having
+ * one of the touched nodes as candidate, and the nodes that got closer to the tour. The distance update is a
+ * linear sweep on squared distances, so the whole heuristic is O(n^2) with a small constant plus O(k log n)
+ * queue updates per insertion.
+ * The tour is returned in inst->succ and its cost in inst->zbest.
+ */
 void extramileage(instance *inst){
     // use directed graph
     inst->directed = true;
 
+    int n = inst->nnodes;
+    engine g;
+    g.inst = inst;
+
     // initialize vectors
-    bool *visited = (bool *) calloc(inst->nnodes, sizeof(bool));
-    inst->xbest = (double *) calloc(inst->nnodes * inst->nnodes, sizeof(double));
+    g.visited = (bool *) calloc(n, sizeof(bool));
+    free(inst->succ);
+    inst->succ = (int *) malloc(n * sizeof(int));
+    g.succ = inst->succ;
 
     // find diameter or convex hull
-    int selected = init_extramileage(inst, visited);
-
-    // add one edge at each iteration
-    for(int it = 0; it < inst->nnodes - selected; it++){
-        double min = DBL_MAX;   // minimum extra-mileage
-        int im, jm, hm;         // minimum corresponding nodes
-
-        // scan selected edges
-        for(int i = 0; i < inst->nnodes; i++){
-            if(!visited[i]) continue; // skip not used nodes
-            if(timeout(inst)) break;
-
-            for(int j = 0; j < inst->nnodes; j++){
-                if(i == j) continue; // skip auto-loops
-                if(!visited[j]) continue; // skip not used nodes
-                if(timeout(inst)) break;
-
-                // select a free node with minimum extra-mileage
-                for(int h = 0; h < inst->nnodes; h++){
-                    if(visited[h]) continue; // skip used nodes
-                    if(inst->xbest[xpos_directed(i, j, inst)] == 0) continue; // skip unselected edges
-                    // compute extra-mileage
-                    double extram = cost(i, h, inst) + cost(h, i, inst) - cost(i, j, inst);
-
-                    // update the minimum
-                    if(extram < min){
-                        min = extram;
-                        im = i;
-                        jm = j;
-                        hm = h;
-                    }
-                }
+    init_extramileage(inst, g.visited, g.succ);
+
+    g.pred = malloc(n * sizeof(int));
+    for(int i = 0; i < n; i++)
+        if(g.visited[i]) g.pred[g.succ[i]] = i;
+
+    // reverse candidate lists
+    const int *cand = candidates(inst);
+    int k = inst->ncand;
+    g.rfirst = calloc(n + 1, sizeof(int));
+    g.ritem = malloc(n * k * sizeof(int));
+    for(int p = 0; p < n * k; p++) g.rfirst[cand[p] + 1]++;
+    for(int v = 0; v < n; v++) g.rfirst[v + 1] += g.rfirst[v];
+    int *next = malloc(n * sizeof(int));
+    memcpy(next, g.rfirst, n * sizeof(int));
+    for(int u = 0; u < n; u++)
+        for(int h = 0; h < k; h++) g.ritem[next[cand[u * k + h]]++] = u;
+    free(next);
+
+    // not visited nodes (swap-remove list)
+    int *todo = malloc(n * sizeof(int));
+    int *where = malloc(n * sizeof(int));
+    int ntodo = 0;
+    int *tour = malloc(n * sizeof(int));
+    int len = 0;
+    for(int i = 0; i < n; i++){
+        if(g.visited[i]) tour[len++] = i;
+        else{
+            where[i] = ntodo;
+            todo[ntodo++] = i;
+        }
+    }
+
+    // initialize the queue of not visited nodes
+    g.ins = malloc(n * sizeof(insertion));
+    g.whead = malloc(n * sizeof(int));
+    g.wnext = malloc(n * sizeof(int));
+    g.wprev = malloc(n * sizeof(int));
+    for(int i = 0; i < n; i++){
+        g.whead[i] = -1;
+        g.ins[i].from = -1;
+    }
+    heap *queue = new_heap(n);
+    for(int p = 0; p < ntodo; p++){
+        int h = todo[p];
+        g.ins[h].dist = DBL_MAX;
+        for(int q = 0; q < len; q++)
+            if(dist2(inst, tour[q], h) < g.ins[h].dist){
+                g.ins[h].dist = dist2(inst, tour[q], h);
+                g.ins[h].near = tour[q];
             }
+        best_insertion(&g, h);
+        heap_push(queue, h, (inst->insertion == RANDOM) ? rand() : priority(inst, &g.ins[h]));
+    }
+    free(tour);
+
+    // add one node at each iteration
+    while(!heap_empty(queue)){
+        int h = heap_pop(queue);
+        int i = g.ins[h].from, j = g.succ[i];
+        unwatch(&g, h);
+
+        // unselect (i, j), select (i, h) and (h, j)
+        g.succ[i] = h;
+        g.succ[h] = j;
+        g.pred[h] = i;
+        g.pred[j] = h;
+        g.visited[h] = true;
+        todo[where[h]] = todo[--ntodo];
+        where[todo[where[h]]] = where[h];
+
+        // nodes whose best edge is gone
+        int u = g.whead[i];
+        while(u >= 0){
+            int w = g.wnext[u];
+            best_insertion(&g, u);
+            update_key(&g, queue, u);
+            u = w;
         }
-        // unselect (im,jm)
-        inst->xbest[xpos_directed(im, jm, inst)] = 0;
-        // select (im, hm) and (hm, jm)
-        inst->xbest[xpos_directed(im, hm, inst)] = 1;
-        inst->xbest[xpos_directed(hm, jm, inst)] = 1;
-        // visit the node
-        visited[hm] = true;
 
-        //plot(inst, inst->xbest);
+        // nodes that may use the new edges
+        int touched[3] = {h, i, j};
+        for(int t = 0; t < 3; t++)
+            for(int p = g.rfirst[touched[t]]; p < g.rfirst[touched[t] + 1]; p++){
+                u = g.ritem[p];
+                if(g.visited[u]) continue;
+                try_edges(&g, h, u);
+                update_key(&g, queue, u);
+            }
+
+        // nodes closer to h than to the rest of the tour, or whose nearest node got a new edge
+        for(int p = 0; p < ntodo; p++){
+            u = todo[p];
+            double d = dist2(inst, h, u);
+            if(d < g.ins[u].dist){
+                g.ins[u].dist = d;
+                g.ins[u].near = h;
+            }else if(g.ins[u].near != i && g.ins[u].near != j)
+                continue;
+            try_edges(&g, h, u);
+            update_key(&g, queue, u);
+        }
 
         if(timeout(inst))
             printerr(inst,"Time-limit too short!");
     }
+    inst->zbest = cost_succ(inst, g.succ);
 
-    free(visited);
-}
\ No newline at end of file
+    free_heap(queue);
+    free(g.ins);
+    free(g.whead);
+    free(g.wnext);
+    free(g.wprev);
+    free(g.rfirst);
+    free(g.ritem);
+    free(todo);
+    free(where);
+    free(g.pred);
+    free(g.visited);
+}
@@ -2,18 +2,39 @@
 // Created by enrico on 07/05/21.
 //
 
+#include <pthread.h>
+#include <stdatomic.h>
 #include "heuristic_greedy.h"
 #include "distances.h"
 #include "formulation_commons.h"
+#include "kdtree.h"
 
 
 #define NONE -1
-#define NTHREAD 4
-
+#define NTHREAD 0   // number of workers (0 = one per core)
+
+// shared state of the workers
+typedef struct{
+    instance *inst;
+    double timelimit;
+    atomic_int next;        // next start node
+    _Atomic double bound;   // cost of inst->succ (or to enter inst->elite), read without locking
+    pthread_mutex_t mutex;  // protects inst->succ, inst->zbest and inst->elite
+} greedy_pool;
+
+typedef struct{
+    greedy_pool *pool;
+    int id;
+    pthread_t thread;
+} greedy_worker;
+
+/**
+ * Find the order-th nearest unvisited node by scanning all the nodes.
+ * Used when the distance is not monotone in the euclidean one (i.e. GEO).
+ */
 int findnearest(instance *inst, const bool * visited, int node, int order){
-    // flag for used nodes
-    bool *selected = calloc(inst->nnodes, sizeof(bool));
-    selected[node] = true;
+    // nodes already found (order is small)
+    int selected[order];
 
     // latest node found
     int latest = NONE;
@@ -24,12 +45,12 @@ int findnearest(instance *inst, const bool * visited, int node, int order){
         double min = DBL_MAX;
         for(int i = 0; i < inst->nnodes; i++) {
             // skip used nodes
-            if(visited[i] || selected[i]) {
-                print(inst, 'D', 3, "Node %d skipped because already %s", i + 1, visited[i]?"visited":"selected");
-                continue;
-            }
+            if(visited[i] || i == node) continue;
+            bool used = false;
+            for(int s = 0; s < k && !used; s++) used = (selected[s] == i);
+            if(used) continue;
+
             double c = cost(node, i, inst);
-            print(inst, 'D', 3, "cost(%d, %d) = %f", node + 1, i + 1, c);
 
             // update the minimum
             if (c < min) {
@@ -38,9 +59,8 @@ int findnearest(instance *inst, const bool * visited, int node, int order){
             }
         }
         if(min == DBL_MAX) break; // nothing found
-        selected[latest] = true; // flag node as used
+        selected[k] = latest; // flag node as used
     }
-    free(selected);
     return latest;
 }
 
@@ -51,42 +71,58 @@ void print_visited(instance *inst, const bool * visited){
     printf("\n");
 }
 
-double gorilla(instance *inst, int nstart, bool *visited, double *result){
+/**
+ * Nearest neighbour tour from nstart
+ * @param inst instance pointer
+ * @param nstart starting node
+ * @param visited scratch array (used when tree is NULL)
+ * @param tree k-d tree on the nodes: visited nodes are deleted from it (NULL to scan all the nodes)
+ * @param succ returned tour
+ * @param bound stop as soon as the partial cost reaches it
+ * @param seed RNG state for GREEDYGRASP
+ * @return tour cost, DBL_MAX if stopped (timeout or bound reached)
+ */
+double gorilla(instance *inst, int nstart, bool *visited, kdtree *tree, int *succ, const _Atomic double *bound,
+               unsigned int *seed){
     print(inst, 'D', 3, "*** Starting from %d ***", nstart + 1);
 
-    // reset arrays
-    bzero(visited, inst->nnodes * sizeof(bool));
-    bzero(result, inst->nnodes * inst->nnodes * sizeof(double));
+    // reset unvisited nodes in O(n)
+    if(tree != NULL)
+        kdtree_reset(tree);
+    else
+        bzero(visited, inst->nnodes * sizeof(bool));
 
     double z = 0;
     int curr = nstart; // current node
-    visited[curr] = true; // flag as used
 
     // find exactly nnodes edges
     for(int i = 0; i < inst->nnodes; i++){
-        //print_visited(inst, visited);
+        // flag as used
+        if(tree != NULL) kdtree_delete(tree, curr);
+        else visited[curr] = true;
 
         int order = 1; // find the nearest node
 
         // use randomness with probability of 15%
-        if(inst->cons_heuristic == GREEDYGRASP && nrand() > 85){
-            int t = nrand();
+        if(inst->cons_heuristic == GREEDYGRASP && nrand_r(seed) > 85){
+            int t = nrand_r(seed);
             if(t > 80) order = 2; // find the 2nd nearest node with probability of 15%
             if(t > 95) order = 3; // find the 3rd nearest node with probability of 5%
         }
 
-        int next = findnearest(inst, visited, curr, order);
+        int next;
+        if(tree != NULL)
+            next = kdtree_nearest(tree, inst->xcoord[curr], inst->ycoord[curr], order);
+        else
+            next = findnearest(inst, visited, curr, order);
 
         // close the circuit if there are no nodes
         if(next == NONE) next = nstart;
 
-        // flag the node
-        visited[next] = true;
-
         print(inst, 'D', 3, "curr = %d, next = %d", curr + 1, next + 1);
 
         // select (curr, next) edge
-        result[xpos_directed(curr, next, inst)] = 1;
+        succ[curr] = next;
 
         // accumulate cost
         z += cost(curr, next, inst);
@@ -94,6 +130,10 @@ double gorilla(instance *inst, int nstart, bool *visited, double *result){
         // update current node
         curr = next;
 
+        // cannot improve the best tour found by any worker
+        if(z >= *bound)
+            return DBL_MAX;
+
         // handling time-limit
         if(timeout(inst))
             return DBL_MAX;
@@ -102,44 +142,91 @@ double gorilla(instance *inst, int nstart, bool *visited, double *result){
     return z;
 }
 
+static void * greedy_work(void *arg){
+    greedy_worker *w = (greedy_worker *) arg;
+    greedy_pool *pool = w->pool;
+    instance *inst = pool->inst;
+    bool grasp = (inst->cons_heuristic == GREEDYGRASP);
+
+    // private buffers and RNG stream
+    kdtree *tree = NULL;
+    bool *visited = NULL;
+    if(inst->dist != GEO)
+        tree = new_kdtree(inst->xcoord, inst->ycoord, inst->nnodes);
+    else
+        visited = (bool *) calloc(inst->nnodes, sizeof(bool));
+    int *succ = (int *) calloc(inst->nnodes, sizeof(int));
+    unsigned int seed = (unsigned int) inst->seed * 2654435761u + w->id + 1;
+
+    while(!timeouts(inst, pool->timelimit)) {
+        // use every nodes as initial node (GRASP: cycle until the time limit)
+        int start = atomic_fetch_add(&pool->next, 1);
+        if(!grasp && start >= inst->nnodes) break;
+
+        // compute gorilla's path
+        double z = gorilla(inst, start % inst->nnodes, visited, tree, succ, &pool->bound, &seed);
+
+        // update the minimum and the elite pool
+        if(z < atomic_load(&pool->bound)){
+            pthread_mutex_lock(&pool->mutex);
+            if(z < inst->zbest){
+                inst->zbest = z;
+                memcpy(inst->succ, succ, inst->nnodes * sizeof(int));
+            }
+            if(inst->elite != NULL){
+                pool_add(inst->elite, succ, z);
+                atomic_store(&pool->bound, pool_threshold(inst->elite));
+            }else
+                atomic_store(&pool->bound, inst->zbest);
+            pthread_mutex_unlock(&pool->mutex);
+        }
+    }
+
+    free_kdtree(tree);
+    free(visited);
+    free(succ);
+    return NULL;
+}
+
+/**
+ * Nearest neighbour heuristic from every node (random choices for GREEDYGRASP).
+ * Start nodes are distributed over a pool of workers.
+ * The best tour is returned in inst->succ and its cost in inst->zbest; the best ones are also added
+ * to inst->elite, if any.
+ */
 void greedy(instance *inst, double timelimit){
-    // set graph as undirected
+    // successors vector is directed
     inst->directed = true;
 
-    // visited nodes
-    bool *visited = (bool *) calloc(inst->nnodes, sizeof(bool));
-
-    // initialize solution vectors
-    double *x = (double *) calloc(inst->nnodes * inst->nnodes, sizeof(double));
-    inst->xbest =  (double *) calloc(inst->nnodes * inst->nnodes, sizeof(double));
+    // initialize solution vector
+    free(inst->succ);
+    inst->succ = (int *) calloc(inst->nnodes, sizeof(int));
 
     // initialize cost
-    double z = inst->zbest = DBL_MAX;
-
-    while(!timeouts(inst, timelimit)) {
-        // use every nodes as initial node
-        for (int start = 0; (start < inst->nnodes) && !timeouts(inst, timelimit); start++) {
-            // compute gorilla's path
-            z = gorilla(inst, start, visited, x);
-
-            // update the minimum
-            if (z < inst->zbest) {
-                inst->zbest = z;
-
-                // swap vectors
-                double *t = x;
-                x = inst->xbest;
-                inst->xbest = t;
-            }
-        }
-
-        // break if deterministic cycle
-        if(inst->cons_heuristic != GREEDYGRASP) break;
+    inst->zbest = DBL_MAX;
+
+    greedy_pool pool;
+    pool.inst = inst;
+    pool.timelimit = timelimit;
+    atomic_init(&pool.next, 0);
+    atomic_init(&pool.bound, DBL_MAX);
+    pthread_mutex_init(&pool.mutex, NULL);
+
+    int nworkers = NTHREAD ? NTHREAD : ncores();
+    if(nworkers > inst->nnodes) nworkers = inst->nnodes;
+    greedy_worker workers[nworkers];
+    for(int i = 0; i < nworkers; i++){
+        workers[i].pool = &pool;
+        workers[i].id = i;
+        if(pthread_create(&workers[i].thread, NULL, greedy_work, &workers[i]))
+            printerr(inst, "Cannot create greedy worker %d", i);
     }
+    for(int i = 0; i < nworkers; i++)
+        pthread_join(workers[i].thread, NULL);
+    pthread_mutex_destroy(&pool.mutex);
 
-    free(visited);
-    free(x);
+    print(inst, 'D', 2, "Greedy: %d workers", nworkers);
 
     if(inst->zbest == DBL_MAX)
         printerr(inst, "Time-limit is too short!");
-}
\ No newline at end of file
+}
@@ -0,0 +1,189 @@
+//
+// Created by enrico on 29/06/21.
+//
+
+#include "heuristic_greedyedge.h"
+#include "distances.h"
+#include "candidates.h"
+#include "kdtree.h"
+
+
+static int degree(const int *adj, int i){
+    return (adj[2 * i] != NONE) + (adj[2 * i + 1] != NONE);
+}
+
+static void link(int *adj, int i, int j){
+    adj[2 * i + (adj[2 * i] != NONE)] = j;
+    adj[2 * j + (adj[2 * j] != NONE)] = i;
+}
+
+// nearest alive fragment endpoint to e by scanning all the endpoints (for GEO distances)
+static int scan_nearest(instance *inst, const bool *alive, int e){
+    int nearest = NONE;
+    double min = DBL_MAX;
+    for(int i = 0; i < inst->nnodes; i++){
+        if(!alive[i]) continue;
+        double c = cost(e, i, inst);
+        if(c < min){
+            min = c;
+            nearest = i;
+        }
+    }
+    return nearest;
+}
+
+/**
+ * Accept edge [i, j] in a set of fragments if both its endpoints have degree < 2 and it doesn't close a cycle
+ * @param adj adjacency lists of the fragments (adj[2i], adj[2i+1], NONE if missing)
+ * @param uf fragments
+ * @return true if the edge was added
+ */
+bool add_fragment_edge(int *adj, unionfind *uf, int i, int j){
+    if(i == j || degree(adj, i) == 2 || degree(adj, j) == 2) return false;
+    if(!uf_union(uf, i, j)) return false; // premature cycle
+    link(adj, i, j);
+    return true;
+}
+
+/**
+ * Join the paths of a set of node-disjoint fragments into a tour, greedily linking the tail of the
+ * current fragment to the nearest free endpoint.
+ *
+ * @param inst instance pointer
+ * @param adj adjacency lists of the fragments (adj[2i], adj[2i+1], NONE if missing), completed in place
+ * @param skip isolated node to leave out of the tour (NONE for none)
+ */
+void join_fragments(instance *inst, int *adj, int skip){
+    int n = inst->nnodes;
+
+    // other endpoint of the fragment of each endpoint
+    int *other = malloc(n * sizeof(int));
+    for(int i = 0; i < n; i++) other[i] = NONE;
+    int first = NONE;
+    for(int i = 0; i < n; i++){
+        int d = degree(adj, i);
+        if(d == 2 || other[i] != NONE || i == skip) continue;
+        if(first == NONE) first = i;
+        if(d == 0){
+            other[i] = i;
+            continue;
+        }
+        int prev = i, curr = adj[2 * i];
+        while(degree(adj, curr) == 2){
+            int next = (adj[2 * curr] == prev) ? adj[2 * curr + 1] : adj[2 * curr];
+            prev = curr;
+            curr = next;
+        }
+        other[i] = curr;
+        other[curr] = i;
+    }
+    if(first == NONE){ // already a tour
+        free(other);
+        return;
+    }
+
+    // free endpoints
+    kdtree *tree = NULL;
+    bool *alive = NULL;
+    if(inst->dist != GEO){
+        tree = new_kdtree(inst->xcoord, inst->ycoord, n);
+        for(int i = 0; i < n; i++)
+            if(degree(adj, i) == 2 || i == skip) kdtree_delete(tree, i);
+    }else{
+        alive = malloc(n * sizeof(bool));
+        for(int i = 0; i < n; i++) alive[i] = (degree(adj, i) < 2 && i != skip);
+    }
+
+    int e = other[first];
+    if(tree != NULL){
+        kdtree_delete(tree, first);
+        kdtree_delete(tree, e);
+    }else
+        alive[first] = alive[e] = false;
+
+    while(true){
+        int next = (tree != NULL) ? kdtree_nearest(tree, inst->xcoord[e], inst->ycoord[e], 1)
+                                  : scan_nearest(inst, alive, e);
+        if(next == NONE) break;
+
+        link(adj, e, next);
+        e = other[next];
+        if(tree != NULL){
+            kdtree_delete(tree, next);
+            kdtree_delete(tree, e);
+        }else
+            alive[next] = alive[e] = false;
+    }
+    // close the tour
+    if(e != first || degree(adj, e) > 0) link(adj, e, first);
+
+    free_kdtree(tree);
+    free(alive);
+    free(other);
+}
+
+/**
+ * Convert the adjacency lists of a tour to a successors vector
+ * @return tour cost
+ */
+double adj_to_succ(instance *inst, const int *adj, int *succ){
+    double z = 0;
+    int prev = adj[1], curr = 0;
+    for(int k = 0; k < inst->nnodes; k++){
+        int next = (adj[2 * curr] == prev) ? adj[2 * curr + 1] : adj[2 * curr];
+        succ[curr] = next;
+        z += cost(curr, next, inst);
+        prev = curr;
+        curr = next;
+    }
+    return z;
+}
+
+/**
+ * Greedy edge heuristic on a given edge order: an edge is accepted if both its endpoints have
+ * degree < 2 and it doesn't close a cycle, then the fragments are joined into a tour.
+ *
+ * @param inst instance pointer
+ * @param edges edge list, edges[2k] and edges[2k+1] are the endpoints of the k-th edge, by decreasing priority
+ * @param nedges number of edges
+ * @param succ returned tour
+ * @return tour cost
+ */
+double greedy_edge_tour(instance *inst, const int *edges, int nedges, int *succ){
+    int n = inst->nnodes;
+    int *adj = malloc(2 * n * sizeof(int));
+    for(int i = 0; i < 2 * n; i++) adj[i] = NONE;
+    unionfind *uf = new_unionfind(n);
+
+    int accepted = 0;
+    for(int k = 0; k < nedges && accepted < n - 1; k++)
+        if(add_fragment_edge(adj, uf, edges[2 * k], edges[2 * k + 1]))
+            accepted++;
+    print(inst, 'D', 2, "Greedy edge: %d edges accepted, %d fragments", accepted, n - accepted);
+
+    join_fragments(inst, adj, NONE);
+    double z = adj_to_succ(inst, adj, succ);
+
+    free_unionfind(uf);
+    free(adj);
+    return z;
+}
+
+/**
+ * Greedy edge (Kruskal-like) heuristic on candidate edges, sorted by increasing cost.
+ * The tour is returned in inst->succ and its cost in inst->zbest.
+ */
+void greedy_edge(instance *inst){
+    // successors vector is directed
+    inst->directed = true;
+
+    int nedges;
+    int *edges = candidate_edges(inst, &nedges);
+    int n = inst->nnodes;
+
+    free(inst->succ);
+    inst->succ = malloc(n * sizeof(int));
+    inst->zbest = greedy_edge_tour(inst, edges, nedges, inst->succ);
+
+    free(edges);
+}
@@ -0,0 +1,23 @@
+//
+// Created by enrico on 29/06/21.
+//
+
+#ifndef TSP_OP2_HEURISTIC_GREEDYEDGE_H
+#define TSP_OP2_HEURISTIC_GREEDYEDGE_H
+
+#include "utils.h"
+#include "unionfind.h"
+
+#define NONE -1
+
+bool add_fragment_edge(int *adj, unionfind *uf, int i, int j);
+
+void join_fragments(instance *inst, int *adj, int skip);
+
+double adj_to_succ(instance *inst, const int *adj, int *succ);
+
+double greedy_edge_tour(instance *inst, const int *edges, int nedges, int *succ);
+
+void greedy_edge(instance *inst);
+
+#endif //TSP_OP2_HEURISTIC_GREEDYEDGE_H
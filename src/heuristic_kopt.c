@@ -7,6 +7,7 @@
 #include "heuristic_kopt.h"
 #include "distances.h"
 #include "plot.h"
+#include "candidates.h"
 
 void reverse_chain(int *succ, int start, int stop){
     // initialize nodes
@@ -77,4 +78,106 @@ double two_opt(instance *inst, int *succ, bool findmin){
             //printsucc(inst, succ);
     }
     return cost_succ(inst, succ);
+}
+
+nodequeue * new_nodequeue(int nnodes){
+    nodequeue *q = malloc(sizeof(nodequeue));
+    q->node = malloc(nnodes * sizeof(int));
+    q->queued = calloc(nnodes, sizeof(bool));
+    q->head = q->len = 0;
+    q->cap = nnodes;
+    return q;
+}
+
+void free_nodequeue(nodequeue *q){
+    if(q == NULL) return;
+    free(q->node);
+    free(q->queued);
+    free(q);
+}
+
+void push_node(nodequeue *q, int i){
+    if(q->queued[i]) return;
+    q->queued[i] = true;
+    int tail = q->head + q->len++;
+    q->node[(tail >= q->cap) ? tail - q->cap : tail] = i;
+}
+
+int pop_node(nodequeue *q){
+    int i = q->node[q->head];
+    if(++q->head == q->cap) q->head = 0;
+    q->len--;
+    q->queued[i] = false;
+    return i;
+}
+
+/**
+ * 2-opt restricted to the active nodes.
+ * Only the moves that add an edge (a, c), being a active and c one of its candidates, are evaluated,
+ * then the endpoints of the changed edges become active again: when few nodes are queued
+ * (e.g. after a kick) the search stays local.
+ * All the changes go through tour_reverse() so they can be rolled back.
+ *
+ * @param inst instance pointer
+ * @param t tour to improve
+ * @param q active nodes (empty on return)
+ * @param findmin apply the best move of each active node instead of the first one
+ * @return cost variation
+ */
+double two_opt_local(instance *inst, tour *t, nodequeue *q, bool findmin){
+    const int *cand = candidates(inst);
+    int ncand = inst->ncand;
+    double delta = 0;
+    long it = 0;
+
+    while(q->len > 0){
+        // handling time-limit
+        if((++it & 255) == 0 && timeout(inst)){
+            while(q->len > 0) pop_node(q);
+            break;
+        }
+
+        int a = pop_node(q);
+        double min = -EPSILON;
+        int mc = -1;
+        bool mpred = false;
+
+        // pred = false: replace (a, a') and (c, c') with (a, c) and (a', c')
+        // pred = true:  replace ('a, a) and ('c, c) with (a, c) and ('a, 'c)
+        for(int pred = 0; pred < 2; pred++){
+            int b = pred ? tour_prev(t, a) : tour_next(t, a);
+            double dab = cost(a, b, inst);
+            for(int k = 0; k < ncand; k++){
+                int c = cand[a * ncand + k];
+                double dac = cost(a, c, inst);
+                if(dac >= dab) break; // no gain: candidates are sorted
+                int d = pred ? tour_prev(t, c) : tour_next(t, c);
+                if(c == b || d == a) continue;
+
+                double delta_ac = dac + cost(b, d, inst) - dab - cost(c, d, inst);
+                if(delta_ac < min){
+                    min = delta_ac;
+                    mc = c;
+                    mpred = pred;
+                    if(!findmin) break;
+                }
+            }
+            if(mc >= 0 && !findmin) break;
+        }
+        if(mc < 0) continue; // a is 2-opt optimal
+
+        int b = mpred ? tour_prev(t, a) : tour_next(t, a);
+        int d = mpred ? tour_prev(t, mc) : tour_next(t, mc);
+        if(mpred)
+            tour_reverse(t, t->pos[a], t->pos[d]);
+        else
+            tour_reverse(t, t->pos[b], t->pos[mc]);
+        delta += min;
+
+        push_node(q, a);
+        push_node(q, b);
+        push_node(q, mc);
+        push_node(q, d);
+    }
+    return delta;
 }
\ No newline at end of file
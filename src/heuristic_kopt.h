@@ -6,13 +6,31 @@
 #define TSP_OP2_HEURISTIC_KOPT_H
 
 #include "utils.h"
+#include "tour.h"
 
 #define EPSILON 0.0000001
 
+// FIFO of the active nodes, i.e. nodes whose neighbourhood must be explored (again)
+typedef struct{
+    int *node;      // ring buffer
+    bool *queued;   // queued[i] iff node i is in the queue
+    int head, len, cap;
+} nodequeue;
+
 void reverse_chain(int *succ, int start, int stop);
 
 double two_opt(instance *inst, int *succ, bool findmin);
 
 void two_opt_move(int *succ, int a, int b);
 
+nodequeue * new_nodequeue(int nnodes);
+
+void free_nodequeue(nodequeue *q);
+
+void push_node(nodequeue *q, int i);
+
+int pop_node(nodequeue *q);
+
+double two_opt_local(instance *inst, tour *t, nodequeue *q, bool findmin);
+
 #endif //TSP_OP2_HEURISTIC_KOPT_H
@@ -0,0 +1,225 @@
+//
+// Created by enrico on 01/07/21.
+//
+
+#include "heuristic_mst.h"
+#include "distances.h"
+#include "candidates.h"
+#include "kdtree.h"
+#include "mst.h"
+
+#define NONE -1
+
+// adjacency lists of a multigraph: the edges of node i are edge[first[i]], ..., edge[first[i + 1] - 1]
+typedef struct{
+    int *first;
+    int *edge;
+} multigraph;
+
+static multigraph build_multigraph(int nnodes, const int *edges, int nedges){
+    multigraph g;
+    g.first = calloc(nnodes + 1, sizeof(int));
+    g.edge = malloc(2 * nedges * sizeof(int));
+    for(int k = 0; k < 2 * nedges; k++) g.first[edges[k] + 1]++;
+    for(int i = 0; i < nnodes; i++) g.first[i + 1] += g.first[i];
+
+    int *next = malloc(nnodes * sizeof(int));
+    memcpy(next, g.first, nnodes * sizeof(int));
+    for(int k = 0; k < nedges; k++){
+        g.edge[next[edges[2 * k]]++] = k;
+        g.edge[next[edges[2 * k + 1]]++] = k;
+    }
+    free(next);
+    return g;
+}
+
+static void free_multigraph(multigraph *g){
+    free(g->first);
+    free(g->edge);
+}
+
+static int other_end(const int *edges, int k, int i){
+    return (edges[2 * k] == i) ? edges[2 * k + 1] : edges[2 * k];
+}
+
+// tour visiting the nodes in the given order
+static void order_to_succ(instance *inst, const int *order){
+    free(inst->succ);
+    inst->succ = malloc(inst->nnodes * sizeof(int));
+    for(int p = 0; p < inst->nnodes; p++)
+        inst->succ[order[p]] = order[(p + 1) % inst->nnodes];
+    inst->zbest = cost_succ(inst, inst->succ);
+}
+
+/**
+ * Double tree heuristic: shortcut of an Eulerian tour of the doubled MST, i.e. visit the nodes
+ * in DFS preorder. Its cost is at most twice the optimal one (for metric instances).
+ * The tour is returned in inst->succ and its cost in inst->zbest.
+ */
+void double_tree(instance *inst){
+    // successors vector is directed
+    inst->directed = true;
+
+    int n = inst->nnodes;
+    int *edges = malloc(2 * (n - 1) * sizeof(int));
+    double z = mst(inst, edges);
+    print(inst, 'D', 2, "MST cost = %f", z);
+    multigraph g = build_multigraph(n, edges, n - 1);
+
+    // iterative DFS from 0
+    int *order = malloc(n * sizeof(int));
+    int *stack = malloc(n * sizeof(int));
+    bool *visited = calloc(n, sizeof(bool));
+    int len = 0, top = 0;
+    stack[top++] = 0;
+    visited[0] = true;
+    while(top > 0){
+        int i = stack[--top];
+        order[len++] = i;
+        for(int p = g.first[i + 1] - 1; p >= g.first[i]; p--){
+            int j = other_end(edges, g.edge[p], i);
+            if(visited[j]) continue;
+            visited[j] = true;
+            stack[top++] = j;
+        }
+    }
+    order_to_succ(inst, order);
+
+    free(order);
+    free(stack);
+    free(visited);
+    free_multigraph(&g);
+    free(edges);
+}
+
+// nearest unmatched odd node by scanning all the nodes (for GEO distances)
+static int scan_nearest(instance *inst, const bool *free_odd, int i){
+    int nearest = NONE;
+    double min = DBL_MAX;
+    for(int j = 0; j < inst->nnodes; j++){
+        if(!free_odd[j]) continue;
+        double c = cost(i, j, inst);
+        if(c < min){
+            min = c;
+            nearest = j;
+        }
+    }
+    return nearest;
+}
+
+/**
+ * Greedy perfect matching on the odd degree nodes: first on candidate edges by increasing cost,
+ * then the leftovers are matched to their nearest unmatched node.
+ *
+ * @param inst instance pointer
+ * @param odd odd[i] iff node i has odd degree
+ * @param edges returned matching edges
+ * @return number of matching edges
+ */
+static int greedy_matching(instance *inst, const bool *odd, int *edges){
+    int n = inst->nnodes;
+    bool *free_odd = malloc(n * sizeof(bool));
+    memcpy(free_odd, odd, n * sizeof(bool));
+    int nmatched = 0;
+
+    int ncandidates;
+    int *cand = candidate_edges(inst, &ncandidates);
+    for(int k = 0; k < ncandidates; k++){
+        int i = cand[2 * k], j = cand[2 * k + 1];
+        if(!free_odd[i] || !free_odd[j]) continue;
+        free_odd[i] = free_odd[j] = false;
+        edges[2 * nmatched] = i;
+        edges[2 * nmatched + 1] = j;
+        nmatched++;
+    }
+    free(cand);
+
+    kdtree *tree = NULL;
+    if(inst->dist != GEO){
+        tree = new_kdtree(inst->xcoord, inst->ycoord, n);
+        for(int i = 0; i < n; i++)
+            if(!free_odd[i]) kdtree_delete(tree, i);
+    }
+    for(int i = 0; i < n; i++){
+        if(!free_odd[i]) continue;
+        free_odd[i] = false;
+        if(tree != NULL) kdtree_delete(tree, i);
+
+        int j = (tree != NULL) ? kdtree_nearest(tree, inst->xcoord[i], inst->ycoord[i], 1)
+                               : scan_nearest(inst, free_odd, i);
+        if(j == NONE)
+            printerr(inst, "greedy_matching(): odd number of odd nodes (internal error)");
+        free_odd[j] = false;
+        if(tree != NULL) kdtree_delete(tree, j);
+
+        edges[2 * nmatched] = i;
+        edges[2 * nmatched + 1] = j;
+        nmatched++;
+    }
+
+    free_kdtree(tree);
+    free(free_odd);
+    return nmatched;
+}
+
+/**
+ * Christofides-like heuristic: MST plus a (greedy) perfect matching on its odd degree nodes,
+ * then an Eulerian circuit of the resulting multigraph (Hierholzer) is shortcut into a tour.
+ * With a greedy matching the 3/2 guarantee is lost, but the tour is usually better than double tree.
+ * The tour is returned in inst->succ and its cost in inst->zbest.
+ */
+void christofides(instance *inst){
+    // successors vector is directed
+    inst->directed = true;
+
+    int n = inst->nnodes;
+
+    // MST edges followed by matching edges (at most n / 2)
+    int *edges = malloc(2 * (n - 1 + n / 2) * sizeof(int));
+    double z = mst(inst, edges);
+    print(inst, 'D', 2, "MST cost = %f", z);
+
+    int *degree = calloc(n, sizeof(int));
+    for(int k = 0; k < 2 * (n - 1); k++) degree[edges[k]]++;
+    bool *odd = malloc(n * sizeof(bool));
+    for(int i = 0; i < n; i++) odd[i] = degree[i] % 2;
+    int nedges = n - 1 + greedy_matching(inst, odd, edges + 2 * (n - 1));
+    free(degree);
+    free(odd);
+
+    multigraph g = build_multigraph(n, edges, nedges);
+
+    // Hierholzer: the circuit is given (backwards) by the popped nodes, shortcut it on the fly
+    int *next = malloc(n * sizeof(int));
+    memcpy(next, g.first, n * sizeof(int));
+    bool *used = calloc(nedges, sizeof(bool));
+    bool *visited = calloc(n, sizeof(bool));
+    int *stack = malloc((nedges + 1) * sizeof(int));
+    int *order = malloc(n * sizeof(int));
+    int len = 0, top = 0;
+    stack[top++] = 0;
+    while(top > 0){
+        int i = stack[top - 1];
+        while(next[i] < g.first[i + 1] && used[g.edge[next[i]]]) next[i]++;
+        if(next[i] == g.first[i + 1]){
+            top--;
+            if(!visited[i]){
+                visited[i] = true;
+                order[len++] = i;
+            }
+            continue;
+        }
+        int k = g.edge[next[i]++];
+        used[k] = true;
+        stack[top++] = other_end(edges, k, i);
+    }
+    order_to_succ(inst, order);
+
+    free(next);
+    free(used);
+    free(visited);
+    free(stack);
+    free(order);
+    free_multigraph(&g);
+    free(edges);
+}
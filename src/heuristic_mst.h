@@ -0,0 +1,14 @@
+//
+// Created by enrico on 01/07/21.
+//
+
+#ifndef TSP_OP2_HEURISTIC_MST_H
+#define TSP_OP2_HEURISTIC_MST_H
+
+#include "utils.h"
+
+void double_tree(instance *inst);
+
+void christofides(instance *inst);
+
+#endif //TSP_OP2_HEURISTIC_MST_H
@@ -0,0 +1,108 @@
+//
+// Created by enrico on 02/07/21.
+//
+
+#include "heuristic_savings.h"
+#include "heuristic_greedyedge.h"
+#include "distances.h"
+#include "candidates.h"
+#include "heap.h"
+
+// node nearest to the centroid
+static int find_hub(instance *inst){
+    double cx = 0, cy = 0;
+    for(int i = 0; i < inst->nnodes; i++){
+        cx += inst->xcoord[i];
+        cy += inst->ycoord[i];
+    }
+    cx /= inst->nnodes;
+    cy /= inst->nnodes;
+
+    int hub = 0;
+    double min = DBL_MAX;
+    for(int i = 0; i < inst->nnodes; i++){
+        double dx = inst->xcoord[i] - cx, dy = inst->ycoord[i] - cy;
+        if(dx * dx + dy * dy < min){
+            min = dx * dx + dy * dy;
+            hub = i;
+        }
+    }
+    return hub;
+}
+
+// put node h in the cheapest position of the tour
+static void insert_node(instance *inst, int *adj, int h){
+    int bi = NONE, bj = NONE;
+    double min = DBL_MAX;
+    for(int i = 0; i < inst->nnodes; i++){
+        if(i == h) continue;
+        for(int s = 0; s < 2; s++){
+            int j = adj[2 * i + s];
+            if(j < i) continue; // each edge once
+            double delta = cost(i, h, inst) + cost(h, j, inst) - cost(i, j, inst);
+            if(delta < min){
+                min = delta;
+                bi = i;
+                bj = j;
+            }
+        }
+    }
+    adj[2 * bi + (adj[2 * bi] != bj)] = h;
+    adj[2 * bj + (adj[2 * bj] != bi)] = h;
+    adj[2 * h] = bi;
+    adj[2 * h + 1] = bj;
+}
+
+/**
+ * Clarke-Wright savings heuristic. Every node starts on its own "hub -> i -> hub" route, and two
+ * routes ending in i and j are merged if that saves s(i, j) = c(hub, i) + c(hub, j) - c(i, j).
+ * The savings of the candidate edges are merged by decreasing value (with a heap), then the routes
+ * left are joined and the hub is put in the cheapest position.
+ * The tour is returned in inst->succ and its cost in inst->zbest.
+ */
+void savings(instance *inst){
+    // successors vector is directed
+    inst->directed = true;
+
+    int n = inst->nnodes;
+    if(n < 4)
+        printerr(inst, "savings(): too few nodes");
+    int hub = find_hub(inst);
+    print(inst, 'D', 2, "Savings: hub = %d", hub + 1);
+
+    int nedges;
+    int *edges = candidate_edges(inst, &nedges);
+
+    // max-heap of savings (edges through the hub are useless)
+    heap *h = new_heap(nedges);
+    for(int k = 0; k < nedges; k++){
+        int i = edges[2 * k], j = edges[2 * k + 1];
+        if(i == hub || j == hub) continue;
+        heap_push(h, k, cost(i, j, inst) - cost(hub, i, inst) - cost(hub, j, inst));
+    }
+
+    int *adj = malloc(2 * n * sizeof(int));
+    for(int i = 0; i < 2 * n; i++) adj[i] = NONE;
+    unionfind *uf = new_unionfind(n);
+
+    // merge routes
+    int merged = 0;
+    while(!heap_empty(h) && merged < n - 2){
+        int k = heap_pop(h);
+        if(add_fragment_edge(adj, uf, edges[2 * k], edges[2 * k + 1]))
+            merged++;
+    }
+    print(inst, 'D', 2, "Savings: %d routes left", n - 1 - merged);
+
+    join_fragments(inst, adj, hub);
+    insert_node(inst, adj, hub);
+
+    free(inst->succ);
+    inst->succ = malloc(n * sizeof(int));
+    inst->zbest = adj_to_succ(inst, adj, inst->succ);
+
+    free_unionfind(uf);
+    free(adj);
+    free_heap(h);
+    free(edges);
+}
@@ -0,0 +1,12 @@
+//
+// Created by enrico on 02/07/21.
+//
+
+#ifndef TSP_OP2_HEURISTIC_SAVINGS_H
+#define TSP_OP2_HEURISTIC_SAVINGS_H
+
+#include "utils.h"
+
+void savings(instance *inst);
+
+#endif //TSP_OP2_HEURISTIC_SAVINGS_H
@@ -0,0 +1,159 @@
+//
+// Created by enrico on 30/06/21.
+//
+
+#include <float.h>
+#include <stdint.h>
+#include <pthread.h>
+#include "heuristic_sfc.h"
+
+#define RADIX_BITS 8
+#define RADIX (1 << RADIX_BITS)
+
+/**
+ * Index of cell (x, y) along the Hilbert curve filling a 2^SFC_ORDER x 2^SFC_ORDER grid
+ */
+static uint32_t hilbert_index(uint32_t x, uint32_t y){
+    const uint32_t side = 1u << SFC_ORDER;
+    uint32_t d = 0;
+    for(uint32_t s = side / 2; s > 0; s /= 2){
+        uint32_t rx = (x & s) > 0;
+        uint32_t ry = (y & s) > 0;
+        d += s * s * ((3 * rx) ^ ry);
+
+        // rotate the quadrant
+        if(ry == 0){
+            if(rx == 1){
+                x = side - 1 - x;
+                y = side - 1 - y;
+            }
+            uint32_t t = x;
+            x = y;
+            y = t;
+        }
+    }
+    return d;
+}
+
+// one pass of the parallel radix sort, on the chunk [lo, hi) of a worker
+typedef struct{
+    const uint64_t *src;
+    uint64_t *dst;
+    int lo, hi;
+    int shift;
+    size_t count[RADIX];    // digit histogram, then scatter offsets
+    pthread_t thread;
+} radix_worker;
+
+static void * radix_count(void *arg){
+    radix_worker *w = (radix_worker *) arg;
+    memset(w->count, 0, sizeof(w->count));
+    for(int i = w->lo; i < w->hi; i++)
+        w->count[(w->src[i] >> w->shift) & (RADIX - 1)]++;
+    return NULL;
+}
+
+static void * radix_scatter(void *arg){
+    radix_worker *w = (radix_worker *) arg;
+    for(int i = w->lo; i < w->hi; i++)
+        w->dst[w->count[(w->src[i] >> w->shift) & (RADIX - 1)]++] = w->src[i];
+    return NULL;
+}
+
+static void run_workers(instance *inst, radix_worker *w, int nworkers, void *(*f)(void *)){
+    if(nworkers == 1){
+        f(&w[0]);
+        return;
+    }
+    for(int t = 0; t < nworkers; t++)
+        if(pthread_create(&w[t].thread, NULL, f, &w[t]))
+            printerr(inst, "Cannot create radix sort worker %d", t);
+    for(int t = 0; t < nworkers; t++)
+        pthread_join(w[t].thread, NULL);
+}
+
+/**
+ * LSD radix sort on bits [lobit, 64) of the keys: every pass builds per-worker histograms
+ * and then every worker scatters its chunk in its own (stable) slots.
+ *
+ * @param inst instance pointer
+ * @param keys array to sort
+ * @param n its length
+ * @param lobit lowest bit of the sort key
+ */
+static void parallel_radix_sort(instance *inst, uint64_t *keys, int n, int lobit){
+    int nworkers = (n < SFC_MIN_PARALLEL) ? 1 : ncores();
+    radix_worker *w = malloc(nworkers * sizeof(radix_worker));
+    uint64_t *tmp = malloc(n * sizeof(uint64_t));
+    uint64_t *src = keys, *dst = tmp;
+
+    for(int shift = lobit; shift < 64; shift += RADIX_BITS){
+        for(int t = 0; t < nworkers; t++){
+            w[t].src = src;
+            w[t].dst = dst;
+            w[t].lo = (int) ((long) n * t / nworkers);
+            w[t].hi = (int) ((long) n * (t + 1) / nworkers);
+            w[t].shift = shift;
+        }
+        run_workers(inst, w, nworkers, radix_count);
+
+        // offsets: digit-major, worker-minor to keep the sort stable
+        size_t offset = 0;
+        for(int d = 0; d < RADIX; d++)
+            for(int t = 0; t < nworkers; t++){
+                size_t c = w[t].count[d];
+                w[t].count[d] = offset;
+                offset += c;
+            }
+        run_workers(inst, w, nworkers, radix_scatter);
+
+        uint64_t *swap = src;
+        src = dst;
+        dst = swap;
+    }
+    if(src != keys)
+        memcpy(keys, src, n * sizeof(uint64_t));
+
+    free(tmp);
+    free(w);
+}
+
+/**
+ * Space filling curve heuristic: visit the nodes in the order of a Hilbert curve over their bounding box.
+ * It takes O(n) time (plus the parallel radix sort), so it's meant as a first incumbent for huge instances.
+ * The tour is returned in inst->succ and its cost in inst->zbest.
+ */
+void space_filling_curve(instance *inst){
+    // successors vector is directed
+    inst->directed = true;
+
+    int n = inst->nnodes;
+
+    // square bounding box, to keep the aspect ratio
+    double xmin = DBL_MAX, xmax = -DBL_MAX, ymin = DBL_MAX, ymax = -DBL_MAX;
+    for(int i = 0; i < n; i++){
+        if(inst->xcoord[i] < xmin) xmin = inst->xcoord[i];
+        if(inst->xcoord[i] > xmax) xmax = inst->xcoord[i];
+        if(inst->ycoord[i] < ymin) ymin = inst->ycoord[i];
+        if(inst->ycoord[i] > ymax) ymax = inst->ycoord[i];
+    }
+    double side = (xmax - xmin > ymax - ymin) ? xmax - xmin : ymax - ymin;
+    double scale = (side > 0) ? ((1u << SFC_ORDER) - 1) / side : 0;
+
+    // key = curve index (high 32 bits) | node (low 32 bits)
+    uint64_t *keys = malloc(n * sizeof(uint64_t));
+    for(int i = 0; i < n; i++){
+        uint32_t x = (uint32_t) ((inst->xcoord[i] - xmin) * scale);
+        uint32_t y = (uint32_t) ((inst->ycoord[i] - ymin) * scale);
+        keys[i] = ((uint64_t) hilbert_index(x, y) << 32) | (uint32_t) i;
+    }
+    parallel_radix_sort(inst, keys, n, 32);
+
+    free(inst->succ);
+    inst->succ = malloc(n * sizeof(int));
+    for(int p = 0; p < n; p++)
+        inst->succ[(int) (uint32_t) keys[p]] = (int) (uint32_t) keys[(p + 1) % n];
+    free(keys);
+
+    inst->zbest = cost_succ(inst, inst->succ);
+}
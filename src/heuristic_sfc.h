@@ -0,0 +1,15 @@
+//
+// Created by enrico on 30/06/21.
+//
+
+#ifndef TSP_OP2_HEURISTIC_SFC_H
+#define TSP_OP2_HEURISTIC_SFC_H
+
+#include "utils.h"
+
+#define SFC_ORDER 16            // bits per coordinate of the Hilbert curve
+#define SFC_MIN_PARALLEL 65536  // don't use threads on smaller instances
+
+void space_filling_curve(instance *inst);
+
+#endif //TSP_OP2_HEURISTIC_SFC_H
@@ -3,106 +3,274 @@
 //
 
 #include <float.h>
+#include <stdint.h>
+#include <limits.h>
 #include "heuristic_tabu_search.h"
 #include "heuristic_kopt.h"
+#include "heuristic_VNS.h"
 #include "distances.h"
+#include "candidates.h"
+
+// open addressing hash table: key -> iteration (plus a counter)
+// key 0 marks an empty slot
+typedef struct{
+    uint64_t *key;
+    long *it;
+    int *count;
+    int cap;        // power of 2
+    int used;
+} itable;
+
+static uint64_t hash64(uint64_t x){
+    // splitmix64 finalizer
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+static void itable_init(itable *h, int cap){
+    h->cap = cap;
+    h->used = 0;
+    h->key = calloc(cap, sizeof(uint64_t));
+    h->it = calloc(cap, sizeof(long));
+    h->count = calloc(cap, sizeof(int));
+}
+
+static void itable_free(itable *h){
+    free(h->key);
+    free(h->it);
+    free(h->count);
+}
+
+static int itable_find(const itable *h, uint64_t key){
+    int s = (int) (hash64(key) & (h->cap - 1));
+    while(h->key[s] != 0 && h->key[s] != key)
+        s = (s + 1) & (h->cap - 1);
+    return s;
+}
+
+// return the slot of key, inserting it (with it = -1 and count = 0) if missing
+static int itable_get(itable *h, uint64_t key){
+    int s = itable_find(h, key);
+    if(h->key[s] == 0){
+        h->key[s] = key;
+        h->it[s] = -1;
+        h->count[s] = 0;
+        h->used++;
+    }
+    return s;
+}
+
+// remove all the entries in place
+static void itable_clear(itable *h){
+    memset(h->key, 0, h->cap * sizeof(uint64_t));
+    h->used = 0;
+}
+
+/**
+ * Remove all the entries with it < min: the table is rebuilt, so it must be done rarely
+ */
+static void itable_purge(itable *h, long min){
+    itable old = *h;
+    itable_init(h, old.cap);
+    for(int s = 0; s < old.cap; s++){
+        if(old.key[s] == 0 || old.it[s] < min) continue;
+        int r = itable_get(h, old.key[s]);
+        h->it[r] = old.it[s];
+        h->count[r] = old.count[s];
+    }
+    itable_free(&old);
+}
+
+// tabu list entry of the (undirected) edge [i, j]
+static uint64_t edge_key(instance *inst, int i, int j){
+    return (i < j) ? (uint64_t) i * inst->nnodes + j + 1 : (uint64_t) j * inst->nnodes + i + 1;
+}
+
+// tour hash is the XOR of its edge hashes, so it's updated in O(1) after each move
+static uint64_t edge_hash(instance *inst, int i, int j){
+    return hash64(edge_key(inst, i, j));
+}
+
+static uint64_t tour_hash(instance *inst, const tour *t){
+    uint64_t hash = 0;
+    for(int p = 0; p < t->nnodes; p++)
+        hash ^= edge_hash(inst, t->node[p], tour_next(t, t->node[p]));
+    return hash;
+}
+
+static bool is_tabu(instance *inst, itable *tabu, int i, int j, long now){
+    int s = itable_find(tabu, edge_key(inst, i, j));
+    return tabu->key[s] != 0 && tabu->it[s] > now;
+}
+
+static void make_tabu(instance *inst, itable *tabu, int i, int j, long now, long tenure){
+    if(2 * tabu->used > tabu->cap)
+        itable_purge(tabu, now + 1); // drop expired entries
+    int s = itable_get(tabu, edge_key(inst, i, j));
+    tabu->it[s] = now + tenure;
+}
+
+/**
+ * Reactive tabu search on the 2-opt neighbourhood restricted to candidate lists.
+ * The tabu attributes are the removed edges: a move is tabu if it adds back an edge removed
+ * in the last `tenure` iterations, unless it improves the best solution (aspiration).
+ * The tenure grows when the search visits again a tour (detected by its hash) and decreases
+ * when it doesn't for a while; tours repeated too often trigger a double-bridge escape.
+ *
+ * @param inst instance pointer
+ * @param t starting tour, returned as the best one found
+ * @param tenure initial tenure
+ * @param seed private RNG state of the escapes (NULL for rand())
+ * @return best cost found
+ */
+double search(instance *inst, tour *t, long tenure, unsigned int *seed){
+    const int *cand = candidates(inst);
+    int ncand = inst->ncand;
+    long max_tenure = (inst->nnodes / 4 < TABU_MAX_TENURE) ? inst->nnodes / 4 : TABU_MAX_TENURE;
+    if(max_tenure < TABU_MIN_TENURE) max_tenure = TABU_MIN_TENURE;
+    if(tenure > max_tenure) tenure = max_tenure;
+    if(tenure < TABU_MIN_TENURE) tenure = TABU_MIN_TENURE;
 
-double search(instance *inst, int *succ, bool findmin, long *tabu, long tenure){
     // initialize local minimum
-    int *xbest = calloc(inst->nnodes, sizeof(int));
-    memcpy(xbest, succ, inst->nnodes * sizeof(int));
-    double zbest = cost_succ(inst, succ);
+    tour *best = new_tour(inst->nnodes);
+    copy_tour(best, t);
+    double z = cost_tour(inst, t);
+    double zbest = z;
+    int *buf = malloc(inst->nnodes * sizeof(int));
+
+    // at most 2 * max_tenure edges are tabu at the same time
+    int cap = 1024;
+    while(cap < 8 * max_tenure) cap *= 2;
+    itable tabu, history;
+    itable_init(&tabu, cap);
+    // tours are compared within a few tenures: the history is forgotten when it's half full
+    int hcap = TABU_MIN_HISTORY;
+    while(hcap < 16 * max_tenure && hcap < TABU_HISTORY) hcap *= 2;
+    itable_init(&history, hcap);
 
-    long now = 0; // iteration counter
+    uint64_t hash = tour_hash(inst, t);
+    long now = 0;           // iteration counter
+    long last_change = 0;   // last tenure update
 
     while(!timeout(inst)){
         now++;
-        bool found = false;
-        double min = DBL_MAX;
-        int a, b;
-
-        // select node pairs (2-opt neighbourhood), skip tabu
-        for(int i = 0; i < inst->nnodes; i++){
-            if((found && !findmin) || timeout(inst)) break;
 
-            // check tabu nodes
-            if(now - tabu[i] <= tenure) {
-                print(inst, 'D', 2, "Node %d is tabu!", i);
-                continue;
+        // record the visit of the current tour
+        int s = itable_get(&history, hash ? hash : 1);
+        if(history.it[s] >= 0){ // seen before: increase tenure
+            if(now - history.it[s] < 2 * max_tenure) {
+                tenure = (long) (1.1 * tenure) + 1;
+                if(tenure > max_tenure) tenure = max_tenure;
+                last_change = now;
             }
+            if(++history.count[s] > TABU_MAX_REPETITIONS){
+                // the search is trapped: escape with a random kick
+                z += kick(inst, t, 4, NULL, buf, seed);
+                hash = tour_hash(inst, t);
+                itable_clear(&history);
+                s = itable_get(&history, hash ? hash : 1);
+                print(inst, 'D', 2, "Tabu search: escape at iteration %ld", now);
+            }
+        }else if(now - last_change > 4 * tenure && tenure > TABU_MIN_TENURE){
+            tenure = (long) (0.9 * tenure);
+            if(tenure < TABU_MIN_TENURE) tenure = TABU_MIN_TENURE;
+            last_change = now;
+        }
+        history.it[s] = now;
+        if(2 * history.used > history.cap)
+            itable_clear(&history); // forget everything
 
-            for(int j = 0; j < inst->nnodes; j++){
-                if((found && !findmin) || timeout(inst)) break;
-                if(i == j) continue;
+        // select the best admissible move among candidate edges
+        double min = DBL_MAX;
+        int ma = -1, mc = -1;
+        bool mpred = false;
+        for(int a = 0; a < inst->nnodes; a++){
+            for(int pred = 0; pred < 2; pred++){
+                int b = pred ? tour_prev(t, a) : tour_next(t, a);
+                double dab = cost(a, b, inst);
+                for(int k = 0; k < ncand; k++){
+                    int c = cand[a * ncand + k];
+                    int d = pred ? tour_prev(t, c) : tour_next(t, c);
+                    if(c == b || d == a) continue;
 
-                // check tabu
-                if(now - tabu[j] <= tenure) {
-                    print(inst, 'D', 2, "Node %d is tabu!", j);
-                    continue;
-                }
+                    double delta = cost(a, c, inst) + cost(b, d, inst) - dab - cost(c, d, inst);
+                    if(delta >= min) continue;
+
+                    // skip tabu moves unless they improve the best solution (aspiration)
+                    if(z + delta >= zbest - EPSILON &&
+                       (is_tabu(inst, &tabu, a, c, now) || is_tabu(inst, &tabu, b, d, now)))
+                        continue;
 
-                double delta = cost(i, j, inst) + cost(succ[i], succ[j], inst)
-                               - cost(i, succ[i], inst) - cost(j, succ[j], inst);
-                if(delta < min) {
                     min = delta;
-                    a = i;
-                    b = j;
-                    found = true;
-                    if(!findmin) break;
+                    ma = a;
+                    mc = c;
+                    mpred = pred;
                 }
             }
         }
 
-        if(!found){
+        if(ma < 0){
             print(inst, 'W', 1, "Cannot find other neighbours!");
             break;
         }
 
-        print(inst, 'D', 2, "Making a two-opt move...");
-        two_opt_move(succ, a, b);
+        // make the move
+        int a = ma, c = mc;
+        int b = mpred ? tour_prev(t, a) : tour_next(t, a);
+        int d = mpred ? tour_prev(t, c) : tour_next(t, c);
+        if(mpred)
+            tour_reverse(t, t->pos[a], t->pos[d]);
+        else
+            tour_reverse(t, t->pos[b], t->pos[c]);
+        z += min;
+        hash ^= edge_hash(inst, a, b) ^ edge_hash(inst, c, d) ^ edge_hash(inst, a, c) ^ edge_hash(inst, b, d);
 
-        // update tabu counters
-        tabu[a] = tabu[b] = now;
+        // removed edges can't be added back for a while
+        make_tabu(inst, &tabu, a, b, now, tenure);
+        make_tabu(inst, &tabu, c, d, now, tenure);
 
         // update minimum
-        double z = cost_succ(inst, succ);
-        if(z < zbest){
+        if(z < zbest - EPSILON){
             zbest = z;
-            memcpy(xbest, succ, inst->nnodes * sizeof(int));
+            copy_tour(best, t);
         }
     }
-    free(xbest);
+    print(inst, 'D', 1, "Tabu search: %ld iterations, final tenure %ld", now, tenure);
+
+    copy_tour(t, best);
+
+    free(buf);
+    free_tour(best);
+    itable_free(&tabu);
+    itable_free(&history);
     return zbest;
 }
 
-double tabu_search(instance *inst, int *succ){
-    long *tabu = calloc(inst->nnodes, sizeof(long));
-    bool findmin;
+double tabu_search(instance *inst, int *succ, unsigned int *seed){
     long tenure;
 
     switch(inst->ref_heuristic){
         case TABU_SEARCH1:
-            findmin = true;
             tenure = 20;
             break;
         case TABU_SEARCH2:
-            findmin = true;
             tenure = inst->nnodes / 10;
             break;
         case TABU_SEARCH3:
-            findmin = true;
             tenure = inst->nnodes / 15;
             break;
         default:
             printerr(inst, "tabu_search(): illegal heuristic");
     }
 
-    // initialize tabu (all nodes are unlocked)
-    for(int i = 0; i < inst->nnodes; i++) tabu[i] = -tenure;
-
     // search on 2-opt neighbours
-    double zbest = search(inst, succ, findmin, tabu, tenure);
+    tour *t = new_tour(inst->nnodes);
+    succtotour(inst, succ, t);
+    search(inst, t, tenure, seed);
+    tourtosucc(t, succ);
+    free_tour(t);
 
-    free(tabu);
-    return zbest;
-}
\ No newline at end of file
+    return cost_succ(inst, succ);
+}
@@ -7,6 +7,12 @@
 #ifndef TSP_OP2_HEURISTIC_TABU_SEARCH_H
 #define TSP_OP2_HEURISTIC_TABU_SEARCH_H
 
-double tabu_search(instance *inst, int *succ);
+#define TABU_MIN_TENURE 5
+#define TABU_MAX_TENURE 10000
+#define TABU_MIN_HISTORY (1 << 12)  // min visited tours hash table size
+#define TABU_HISTORY (1 << 20)      // max visited tours hash table size
+#define TABU_MAX_REPETITIONS 3      // max visits of the same tour before escaping
+
+double tabu_search(instance *inst, int *succ, unsigned int *seed);
 
 #endif //TSP_OP2_HEURISTIC_TABU_SEARCH_H
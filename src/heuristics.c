@@ -3,26 +3,28 @@
 //
 
 #include <unistd.h>
+#include <sys/time.h>
 #include "heuristics.h"
 #include "heuristic_greedy.h"
+#include "heuristic_greedyedge.h"
+#include "heuristic_sfc.h"
+#include "heuristic_mst.h"
+#include "heuristic_savings.h"
 #include "heuristic_extramileage.h"
 #include "tsp.h"
 #include "heuristic_kopt.h"
 #include "heuristic_VNS.h"
 #include "heuristic_tabu_search.h"
+#include "candidates.h"
 
-void heuristic(instance * inst){
-    // initialize starting time
-    start(inst);
-
-    // define time limit for construction heuristics
-    double timelimit;
-    if(inst->ref_heuristic != RHLAST)
-        timelimit = inst->time_limit/2;
-    else
-        timelimit = inst->time_limit;
-
-    // choose constructive heuristic
+/**
+ * Run the constructive heuristic inst->cons_heuristic.
+ * The tour is returned in inst->succ and its cost in inst->zbest.
+ *
+ * @param inst instance pointer
+ * @param timelimit time limit of the greedy heuristics (from inst->tstart)
+ */
+static void construct(instance *inst, double timelimit){
     switch(inst->cons_heuristic){
         case EXTRAMILEAGE:
         case EXTRAMILEAGECONVEXHULL:
@@ -34,23 +36,34 @@ void heuristic(instance * inst){
         case GREEDYGRASP:
             greedy(inst, timelimit);
             break;
+        case GREEDYEDGE:
+            greedy_edge(inst);
+            break;
+        case SPACEFILLINGCURVE:
+            space_filling_curve(inst);
+            break;
+        case DOUBLETREE:
+            double_tree(inst);
+            break;
+        case CHRISTOFIDES:
+            christofides(inst);
+            break;
+        case SAVINGS:
+            savings(inst);
+            break;
         default:
             printerr(inst, "Heuristic not found (internal error)");
     }
+    inst->zbest = cost_succ(inst, inst->succ);
+}
 
-    if(inst->verbose >= 30)
-        plot(inst, inst->xbest);
-
-    // convert xbest to successors vector
-    inst->succ = xtosucc(inst, inst->xbest);
-
-    // record initial cost
-    double initial_cost = cost_succ(inst, inst->succ);
-
-    // NB --verbose 3 is more precise than --verbose 1
-    // NB that's because it starts from a different (worse!) starting solution!
-
-    // choose refinement heuristic
+/**
+ * Run the refinement heuristic inst->ref_heuristic on inst->succ.
+ *
+ * @param inst instance pointer
+ * @return cost of the refined tour, also in inst->zbest
+ */
+static double refine(instance *inst){
     switch(inst->ref_heuristic) {
         case TWO_OPT:
             inst->zbest = two_opt(inst, inst->succ, false);
@@ -60,18 +73,46 @@ void heuristic(instance * inst){
             break;
         case VNS1:
         case VNS2:
-            inst->zbest = VNS(inst);
+            inst->zbest = VNS(inst, NULL);
             break;
         case TABU_SEARCH1:
         case TABU_SEARCH2:
         case TABU_SEARCH3:
-            inst->zbest = tabu_search(inst, inst->succ);
+            inst->zbest = tabu_search(inst, inst->succ, NULL);
             break;
         default:
             print(inst, 'D', 3, "No refinement heuristic used");
-            inst->zbest = initial_cost;
+            inst->zbest = cost_succ(inst, inst->succ);
             break;
     }
+    return inst->zbest;
+}
+
+void heuristic(instance * inst){
+    // initialize starting time
+    start(inst);
+
+    // define time limit for construction heuristics
+    double timelimit;
+    if(inst->ref_heuristic != RHLAST)
+        timelimit = inst->time_limit/2;
+    else
+        timelimit = inst->time_limit;
+
+    // choose constructive heuristic
+    construct(inst, timelimit);
+
+    if(inst->do_plot && inst->verbose >= 30)
+        plot_succ(inst, inst->succ);
+
+    // record initial cost
+    double initial_cost = inst->zbest;
+
+    // NB --verbose 3 is more precise than --verbose 1
+    // NB that's because it starts from a different (worse!) starting solution!
+
+    // choose refinement heuristic
+    refine(inst);
 
     print(inst, 'I', 1, "Initial cost = %f", initial_cost);
     print(inst, 'I', 1, "Found zbest = %f", inst->zbest);
@@ -83,13 +124,94 @@ void heuristic(instance * inst){
         print(inst, 'I', 1, "Known solution z* = %f, ratio = %f, error = %f%", zopt, ratio, error);
     }
 
-    plot_succ(inst, inst->succ);
+    if(inst->do_plot)
+        plot_succ(inst, inst->succ);
 }
 
 void initial_solution(instance *inst, double timelimit){
     start(inst);
     greedy(inst, timelimit);
-    inst->succ = xtosucc(inst, inst->xbest);
     two_opt(inst, inst->succ, true);
     // return as inst->succ
-}
\ No newline at end of file
+}
+
+/**
+ * Heuristic warm start of exact methods and matheuristics: run the --warm-start chain (or the given
+ * constructive heuristic) within the warm-start time budget.
+ * The best tour is returned in inst->succ and its cost in inst->zbest; the best distinct tours found,
+ * refined by 2-opt, are kept in inst->elite (see add_mipstarts()).
+ *
+ * @param inst instance pointer
+ * @param cons constructive heuristic used when the chain is not given
+ */
+void warm_start(instance *inst, enum cons_heuristic_t cons){
+    warm_start_pool(inst, cons, WS_NSTARTS);
+}
+
+/**
+ * Warm start keeping the given number of tours in inst->elite.
+ *
+ * @param inst instance pointer
+ * @param cons constructive heuristic used when the chain is not given
+ * @param size pool size
+ */
+void warm_start_pool(instance *inst, enum cons_heuristic_t cons, int size){
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    double elapsed = (double) (now.tv_sec - inst->tstart.tv_sec);
+
+    double budget = inst->ws_time;
+    if(budget <= 0)
+        budget = (inst->time_limit < CPX_INFBOUND) ? WS_TIME * inst->time_limit : WS_MAXTIME;
+
+    // heuristics stop on timeout(): restrict the time limit to the budget
+    double time_limit = inst->time_limit;
+    enum cons_heuristic_t cons_heuristic = inst->cons_heuristic;
+    enum ref_heuristic_t ref_heuristic = inst->ref_heuristic;
+    inst->time_limit = elapsed + budget;
+    inst->cons_heuristic = (inst->ws_cons != CHLAST) ? inst->ws_cons : cons;
+
+    free_tourpool(inst->elite);
+    inst->elite = new_tourpool(inst->nnodes, size);
+
+    // constructive heuristic: greedy ones fill the pool
+    construct(inst, elapsed + ((inst->ws_nref > 0) ? budget / 2 : budget));
+    pool_add(inst->elite, inst->succ, inst->zbest);
+    print(inst, 'I', 1, "Warm start: %s, z = %f", cons_heuristic_names[inst->cons_heuristic], inst->zbest);
+
+    // refinement chain on the best tour
+    for(int k = 0; k < inst->ws_nref; k++){
+        inst->ref_heuristic = inst->ws_ref[k];
+        refine(inst);
+        pool_add(inst->elite, inst->succ, inst->zbest);
+        print(inst, 'I', 1, "Warm start: %s, z = %f", ref_heuristic_names[inst->ref_heuristic], inst->zbest);
+    }
+
+    // 2-opt on the other tours of the pool
+    tourpool *elite = new_tourpool(inst->nnodes, size);
+    tour *t = new_tour(inst->nnodes);
+    nodequeue *q = new_nodequeue(inst->nnodes);
+    candidates(inst);
+    for(int k = 0; k < inst->elite->size; k++){
+        succtotour(inst, inst->elite->succ[k], t);
+        for(int i = 0; i < inst->nnodes; i++)
+            push_node(q, i);
+        double z = inst->elite->z[k] + two_opt_local(inst, t, q, false);
+        tourtosucc(t, inst->elite->succ[k]);
+        pool_add(elite, inst->elite->succ[k], z);
+    }
+    free_nodequeue(q);
+    free_tour(t);
+    free_tourpool(inst->elite);
+    inst->elite = elite;
+
+    if(elite->z[0] < inst->zbest){
+        inst->zbest = elite->z[0];
+        memcpy(inst->succ, elite->succ[0], inst->nnodes * sizeof(int));
+    }
+    print(inst, 'I', 1, "Warm start: %d tours, best z = %f", elite->size, inst->zbest);
+
+    inst->time_limit = time_limit;
+    inst->cons_heuristic = cons_heuristic;
+    inst->ref_heuristic = ref_heuristic;
+}
@@ -7,8 +7,16 @@
 
 #include "utils.h"
 
+#define WS_TIME 0.1         // default warm-start budget (fraction of the time limit)
+#define WS_MAXTIME 60       // default warm-start budget without time limit (seconds)
+#define WS_NSTARTS 5        // max number of MIP starts from the warm start
+
 void heuristic(instance *);
 
 void initial_solution(instance *inst, double timelimit);
 
+void warm_start(instance *inst, enum cons_heuristic_t cons);
+
+void warm_start_pool(instance *inst, enum cons_heuristic_t cons, int size);
+
 #endif //TSP_OP2_HEURISTICS_H
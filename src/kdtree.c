@@ -0,0 +1,209 @@
+//
+// Created by enrico on 28/06/21.
+//
+
+#include <stdlib.h>
+#include <string.h>
+#include <float.h>
+#include "kdtree.h"
+
+/**
+ * Quickselect: put in idx[k] the point that would be there if idx[lo, hi) was sorted along d,
+ * with the smaller points before it and the larger ones after it.
+ *
+ * @param x points x coordinates
+ * @param y points y coordinates
+ * @param idx points to select from
+ * @param d dimension (0 = x, 1 = y)
+ */
+void kdtree_select(const double *x, const double *y, int *idx, int lo, int hi, int k, int d){
+    const double *c = d ? y : x;
+    hi--;
+    while(lo < hi){
+        double pivot = c[idx[(lo + hi) / 2]];
+        int i = lo, j = hi;
+        while(i <= j){
+            while(c[idx[i]] < pivot) i++;
+            while(c[idx[j]] > pivot) j--;
+            if(i <= j){
+                int tmp = idx[i];
+                idx[i++] = idx[j];
+                idx[j--] = tmp;
+            }
+        }
+        if(k <= j) hi = j;
+        else if(k >= i) lo = i;
+        else break;
+    }
+}
+
+static void build(kdtree *t, int lo, int hi){
+    if(lo >= hi) return;
+    int mid = (lo + hi) / 2;
+
+    // split along the largest extent
+    double xmin = DBL_MAX, xmax = -DBL_MAX, ymin = DBL_MAX, ymax = -DBL_MAX;
+    for(int p = lo; p < hi; p++){
+        double x = t->x[t->idx[p]], y = t->y[t->idx[p]];
+        if(x < xmin) xmin = x;
+        if(x > xmax) xmax = x;
+        if(y < ymin) ymin = y;
+        if(y > ymax) ymax = y;
+    }
+    char d = (ymax - ymin > xmax - xmin) ? 1 : 0;
+
+    kdtree_select(t->x, t->y, t->idx, lo, hi, mid, d);
+    t->dim[mid] = d;
+    t->count0[mid] = hi - lo;
+
+    build(t, lo, mid);
+    build(t, mid + 1, hi);
+}
+
+/**
+ * Build a 2-d tree in O(n log n)
+ * @param x points abscissae
+ * @param y points ordinates
+ * @param n number of points
+ * @return a tree with all the points alive
+ */
+kdtree * new_kdtree(const double *x, const double *y, int n){
+    kdtree *t = malloc(sizeof(kdtree));
+    t->n = n;
+    t->x = x;
+    t->y = y;
+    t->idx = malloc(n * sizeof(int));
+    t->where = malloc(n * sizeof(int));
+    t->dim = malloc(n * sizeof(char));
+    t->count = malloc(n * sizeof(int));
+    t->count0 = malloc(n * sizeof(int));
+    t->alive = malloc(n * sizeof(bool));
+
+    for(int i = 0; i < n; i++) t->idx[i] = i;
+    build(t, 0, n);
+    t->px = malloc(n * sizeof(double));
+    t->py = malloc(n * sizeof(double));
+    for(int p = 0; p < n; p++){
+        t->where[t->idx[p]] = p;
+        t->px[p] = x[t->idx[p]];
+        t->py[p] = y[t->idx[p]];
+    }
+
+    kdtree_reset(t);
+    return t;
+}
+
+void free_kdtree(kdtree *t){
+    if(t == NULL) return;
+    free(t->idx);
+    free(t->px);
+    free(t->py);
+    free(t->where);
+    free(t->dim);
+    free(t->count);
+    free(t->count0);
+    free(t->alive);
+    free(t);
+}
+
+// make all the points alive again in O(n)
+void kdtree_reset(kdtree *t){
+    memcpy(t->count, t->count0, t->n * sizeof(int));
+    for(int i = 0; i < t->n; i++) t->alive[i] = true;
+}
+
+// add or remove 1 to the counts from the root down to the node of position p
+static void update_counts(kdtree *t, int p, int delta){
+    int lo = 0, hi = t->n;
+    while(lo < hi){
+        int mid = (lo + hi) / 2;
+        t->count[mid] += delta;
+        if(p == mid) break;
+        if(p < mid) hi = mid;
+        else lo = mid + 1;
+    }
+}
+
+// delete point i in O(log n)
+void kdtree_delete(kdtree *t, int i){
+    if(!t->alive[i]) return;
+    t->alive[i] = false;
+    update_counts(t, t->where[i], -1);
+}
+
+// make a deleted point i alive again in O(log n)
+void kdtree_insert(kdtree *t, int i){
+    if(t->alive[i]) return;
+    t->alive[i] = true;
+    update_counts(t, t->where[i], +1);
+}
+
+// nearest points found so far, sorted by distance
+typedef struct{
+    int k, len;
+    int point[KD_MAXK];
+    double dist[KD_MAXK];
+} knn_list;
+
+static void knn_add(knn_list *l, int i, double d){
+    if(l->len == l->k && d >= l->dist[l->k - 1]) return;
+    int p = (l->len < l->k) ? l->len++ : l->k - 1;
+    while(p > 0 && l->dist[p - 1] > d){
+        l->dist[p] = l->dist[p - 1];
+        l->point[p] = l->point[p - 1];
+        p--;
+    }
+    l->dist[p] = d;
+    l->point[p] = i;
+}
+
+static void search(const kdtree *t, int lo, int hi, double qx, double qy, knn_list *l){
+    if(lo >= hi) return;
+    int mid = (lo + hi) / 2;
+    if(t->count[mid] == 0) return; // nothing alive here
+
+    int i = t->idx[mid];
+    if(t->alive[i]){
+        double dx = t->px[mid] - qx, dy = t->py[mid] - qy;
+        knn_add(l, i, dx * dx + dy * dy);
+    }
+
+    double diff = t->dim[mid] ? qy - t->py[mid] : qx - t->px[mid];
+    if(diff < 0){
+        search(t, lo, mid, qx, qy, l);
+        if(l->len < l->k || diff * diff < l->dist[l->len - 1])
+            search(t, mid + 1, hi, qx, qy, l);
+    }else{
+        search(t, mid + 1, hi, qx, qy, l);
+        if(l->len < l->k || diff * diff < l->dist[l->len - 1])
+            search(t, lo, mid, qx, qy, l);
+    }
+}
+
+/**
+ * Find the k nearest alive points to (qx, qy) w.r.t. the euclidean distance
+ * @param t tree
+ * @param qx query abscissa
+ * @param qy query ordinate
+ * @param k number of points (at most KD_MAXK)
+ * @param nearest returned points, sorted by distance
+ * @return number of points found (less than k if there are not enough alive points)
+ */
+int kdtree_knn(const kdtree *t, double qx, double qy, int k, int *nearest){
+    knn_list l;
+    l.k = (k < KD_MAXK) ? k : KD_MAXK;
+    l.len = 0;
+    search(t, 0, t->n, qx, qy, &l);
+    memcpy(nearest, l.point, l.len * sizeof(int));
+    return l.len;
+}
+
+/**
+ * Find the k-th nearest alive point to (qx, qy)
+ * @return the k-th nearest point (or the farthest one if there are less than k alive points), -1 if none
+ */
+int kdtree_nearest(const kdtree *t, double qx, double qy, int k){
+    int nearest[KD_MAXK];
+    int len = kdtree_knn(t, qx, qy, k, nearest);
+    return (len == 0) ? -1 : nearest[len - 1];
+}
@@ -0,0 +1,42 @@
+//
+// Created by enrico on 28/06/21.
+//
+
+#ifndef TSP_OP2_KDTREE_H
+#define TSP_OP2_KDTREE_H
+
+#include <stdbool.h>
+
+#define KD_MAXK 32  // max order of a nearest neighbour query
+
+// 2-d tree over a set of points supporting deletion of points.
+// It is stored implicitly: the node of the subtree covering positions [lo, hi) is at position (lo + hi) / 2
+typedef struct{
+    int n;
+    const double *x, *y;    // points coordinates (not owned)
+    int *idx;               // idx[p] = point at position p
+    double *px, *py;        // coordinates of idx[p] (contiguous, for cache locality)
+    int *where;             // where[i] = position of point i
+    char *dim;              // split dimension of each node (0 = x, 1 = y)
+    int *count;             // alive points in each subtree
+    int *count0;            // initial counts (for resetting)
+    bool *alive;            // alive[i] iff point i was not deleted
+} kdtree;
+
+kdtree * new_kdtree(const double *x, const double *y, int n);
+
+void free_kdtree(kdtree *t);
+
+void kdtree_reset(kdtree *t);
+
+void kdtree_delete(kdtree *t, int i);
+
+void kdtree_insert(kdtree *t, int i);
+
+int kdtree_knn(const kdtree *t, double qx, double qy, int k, int *nearest);
+
+int kdtree_nearest(const kdtree *t, double qx, double qy, int k);
+
+void kdtree_select(const double *x, const double *y, int *idx, int lo, int hi, int k, int d);
+
+#endif //TSP_OP2_KDTREE_H
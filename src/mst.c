@@ -0,0 +1,145 @@
+//
+// Created by enrico on 01/07/21.
+//
+
+#include "mst.h"
+#include "distances.h"
+#include "candidates.h"
+#include "unionfind.h"
+#include "kdtree.h"
+
+#define NONE -1
+
+// nearest node of another component by scanning all the nodes (for GEO distances)
+static int scan_nearest(instance *inst, unionfind *uf, int i){
+    int nearest = NONE;
+    double min = DBL_MAX;
+    int ri = uf_find(uf, i);
+    for(int j = 0; j < inst->nnodes; j++){
+        if(uf_find(uf, j) == ri) continue;
+        double c = cost(i, j, inst);
+        if(c < min){
+            min = c;
+            nearest = j;
+        }
+    }
+    return nearest;
+}
+
+/**
+ * Connect the components of a spanning forest with Boruvka steps on the complete graph:
+ * every component is joined to its nearest node outside it, until one component is left.
+ *
+ * @param inst instance pointer
+ * @param uf components of the forest
+ * @param edges forest edges, updated
+ * @param nedges number of forest edges, updated
+ * @return cost of the added edges
+ */
+static double connect_components(instance *inst, unionfind *uf, int *edges, int *nedges){
+    int n = inst->nnodes;
+    double z = 0;
+
+    kdtree *tree = (inst->dist != GEO) ? new_kdtree(inst->xcoord, inst->ycoord, n) : NULL;
+
+    // nodes grouped by component
+    int *root = malloc(n * sizeof(int));
+    int *order = malloc(n * sizeof(int));
+    int *first = malloc((n + 1) * sizeof(int));
+    // cheapest outgoing edge of each component (indexed by root)
+    int *best_i = malloc(n * sizeof(int));
+    int *best_j = malloc(n * sizeof(int));
+    double *best_c = malloc(n * sizeof(double));
+
+    while(uf->nsets > 1){
+        print(inst, 'D', 2, "MST: connecting %d components", uf->nsets);
+
+        // counting sort of the nodes by root
+        for(int i = 0; i <= n; i++) first[i] = 0;
+        for(int i = 0; i < n; i++){
+            root[i] = uf_find(uf, i);
+            first[root[i] + 1]++;
+        }
+        for(int r = 0; r < n; r++) first[r + 1] += first[r];
+        for(int i = 0; i < n; i++) order[first[root[i]]++] = i;
+        for(int r = n; r > 0; r--) first[r] = first[r - 1];
+        first[0] = 0;
+
+        for(int r = 0; r < n; r++){
+            best_c[r] = DBL_MAX;
+            if(first[r] == first[r + 1]) continue; // not a root
+
+            // hide the component, so queries return nodes outside it
+            if(tree != NULL)
+                for(int p = first[r]; p < first[r + 1]; p++) kdtree_delete(tree, order[p]);
+
+            for(int p = first[r]; p < first[r + 1]; p++){
+                int i = order[p];
+                int j = (tree != NULL) ? kdtree_nearest(tree, inst->xcoord[i], inst->ycoord[i], 1)
+                                       : scan_nearest(inst, uf, i);
+                double c = cost(i, j, inst);
+                if(c < best_c[r]){
+                    best_c[r] = c;
+                    best_i[r] = i;
+                    best_j[r] = j;
+                }
+            }
+
+            if(tree != NULL)
+                for(int p = first[r]; p < first[r + 1]; p++) kdtree_insert(tree, order[p]);
+        }
+
+        // add the cheapest edges (skipping the ones that became internal)
+        for(int r = 0; r < n; r++){
+            if(best_c[r] == DBL_MAX) continue;
+            if(!uf_union(uf, best_i[r], best_j[r])) continue;
+            edges[2 * *nedges] = best_i[r];
+            edges[2 * *nedges + 1] = best_j[r];
+            (*nedges)++;
+            z += best_c[r];
+        }
+    }
+
+    free_kdtree(tree);
+    free(root);
+    free(order);
+    free(first);
+    free(best_i);
+    free(best_j);
+    free(best_c);
+    return z;
+}
+
+/**
+ * Minimum spanning tree: Kruskal on the candidate graph, then its components (if any) are
+ * connected with Boruvka steps. It's exact whenever the MST is contained in the candidate graph,
+ * which is almost always the case for geometric instances.
+ *
+ * @param inst instance pointer
+ * @param edges returned tree edges (n - 1), edges[2k] and edges[2k+1] are the endpoints of the k-th edge
+ * @return tree cost
+ */
+double mst(instance *inst, int *edges){
+    int n = inst->nnodes;
+    int ncandidates;
+    int *cand = candidate_edges(inst, &ncandidates);
+    unionfind *uf = new_unionfind(n);
+
+    double z = 0;
+    int nedges = 0;
+    for(int k = 0; k < ncandidates && nedges < n - 1; k++){
+        int i = cand[2 * k], j = cand[2 * k + 1];
+        if(!uf_union(uf, i, j)) continue;
+        edges[2 * nedges] = i;
+        edges[2 * nedges + 1] = j;
+        nedges++;
+        z += cost(i, j, inst);
+    }
+    free(cand);
+
+    if(uf->nsets > 1)
+        z += connect_components(inst, uf, edges, &nedges);
+
+    free_unionfind(uf);
+    return z;
+}
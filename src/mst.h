@@ -0,0 +1,12 @@
+//
+// Created by enrico on 01/07/21.
+//
+
+#ifndef TSP_OP2_MST_H
+#define TSP_OP2_MST_H
+
+#include "utils.h"
+
+double mst(instance *inst, int *edges);
+
+#endif //TSP_OP2_MST_H
@@ -4,6 +4,48 @@
 
 #include "parsers.h"
 
+/**
+ * Parse a heuristic chain: a constructive heuristic followed by refinement heuristics, separated by '+'
+ * (e.g. greedy-grasp+vns2).
+ *
+ * @param inst general instance: returns inst->ws_cons, inst->ws_ref and inst->ws_nref
+ * @param chain heuristic chain
+ */
+static void parse_chain(instance *inst, const char *chain){
+    char *copy = strdup(chain);
+    char *save = NULL;
+    char *token = strtok_r(copy, "+", &save);
+    inst->ws_cons = CHLAST;
+    inst->ws_nref = 0;
+
+    if(token != NULL)
+        for(int k = 0; k < CHLAST; k++)
+            if(strcasecmp(token, cons_heuristic_names[k]) == 0)
+                inst->ws_cons = k;
+    if(inst->ws_cons == CHLAST){
+        free(copy);
+        printerr(inst, "Unknown constructive heuristic in warm-start chain: %s", chain);
+    }
+
+    while((token = strtok_r(NULL, "+", &save)) != NULL){
+        if(inst->ws_nref == WS_MAXCHAIN){
+            free(copy);
+            printerr(inst, "Too many refinement heuristics in warm-start chain (max %d)", WS_MAXCHAIN);
+        }
+        bool found = false;
+        for(int k = 0; k < RHLAST && !found; k++)
+            if(strcasecmp(token, ref_heuristic_names[k]) == 0){
+                inst->ws_ref[inst->ws_nref++] = k;
+                found = true;
+            }
+        if(!found){
+            free(copy);
+            printerr(inst, "Unknown refinement heuristic in warm-start chain: %s", chain);
+        }
+    }
+    free(copy);
+}
+
 void parse_cli(int argc, char **argv, instance *inst){
     // parse cli
     bool help = false;
@@ -62,6 +104,33 @@ void parse_cli(int argc, char **argv, instance *inst){
             }
             continue;
         }
+        if(strcmp(argv[i],"--warm-start") == 0){
+            if(argv[++i] != NULL)
+                parse_chain(inst, argv[i]);
+            continue;
+        }
+        if(strcmp(argv[i],"--warm-start-time") == 0){
+            if(argv[++i] != NULL) {
+                inst->ws_time = atof(argv[i]);
+                if(inst->ws_time <= 0)
+                    printerr(inst, "Warm-start time must be positive!");
+            }
+            continue;
+        }
+        if(strcmp(argv[i],"--insertion") == 0){
+            if(argv[++i] != NULL) {
+                bool found = false;
+                for(int k = 0; k < ILAST; k++)
+                    if (strcasecmp(argv[i], insertion_names[k]) == 0) {
+                        inst->insertion = k;
+                        found = true;
+                        break;
+                    }
+                if(!found)
+                    printerr(inst, "Unknown insertion policy");
+            }
+            continue;
+        }
         if(strcmp(argv[i],"--seed") == 0){
             if(argv[++i] != NULL)
                 inst->seed = atoi(argv[i]);
@@ -73,6 +142,7 @@ void parse_cli(int argc, char **argv, instance *inst){
             continue;
         }
         if(strcmp(argv[i],"--lazy")  == 0){ inst->lazy = true; continue;}
+        if(strcmp(argv[i],"--sparse")  == 0){ inst->sparse = true; continue;}
         if(strcmp(argv[i],"--time-limit") == 0){
             if(argv[++i] != NULL){
                 inst->time_limit = atof(argv[i]);
@@ -147,8 +217,15 @@ void parse_cli(int argc, char **argv, instance *inst){
         printf("--formulation               %s\n", formulation_names[inst->formulation]);
         printf("--constructive-heuristic    %s\n", cons_heuristic_names[inst->cons_heuristic]);
         printf("--refinement-heuristic      %s\n", ref_heuristic_names[inst->ref_heuristic]);
+        printf("--insertion                 %s\n", insertion_names[inst->insertion]);
+        printf("--warm-start                %s", (inst->ws_cons != CHLAST) ? cons_heuristic_names[inst->ws_cons] : "default");
+        for(int k = 0; k < inst->ws_nref; k++)
+            printf("+%s", ref_heuristic_names[inst->ws_ref[k]]);
+        printf("\n");
+        printf("--warm-start-time           %f\n", inst->ws_time);
         printf("--seed                      %d\n", inst->seed);
         printf("--lazy                      %s\n", inst->lazy?"true":"false");
+        printf("--sparse                    %s\n", inst->sparse?"true":"false");
         printf("--time-limit                %f\n", inst->time_limit);
         printf("--mem-limit                 %f\n", inst->mem_limit);
         printf("--no-gui                    %s\n", inst->gui?"false":"true");
@@ -16,6 +16,10 @@
                 "--opt-tour <file-opt-tsp>          tsp file with optimal tour\n" \
                 "--formulation <form>               standard, MTZ or GG\n" \
                 "--lazy                             use lazy constraints\n"\
+                "--sparse                           cuts: start from candidate edges, add the others by pricing\n"\
+                "--warm-start <chain>               heuristic warm start of exact methods, e.g. greedy-grasp+vns2\n"\
+                "--warm-start-time <time>           warm-start time budget in seconds\n"\
+                "--insertion <policy>               extra-mileage insertion: cheapest, nearest, farthest or random\n" \
                 "--time-limit <time>                max overall time in seconds\n" \
                 "--mem-limit <MB>                   max memory for CPLEX decision tree\n" \
                 "--seed <seed>                      a random integer used in CPLEX internal operations\n" \
@@ -132,6 +132,18 @@ void reset_instance(instance *dummy_inst){
     free(dummy_inst->xbest);
     dummy_inst->xbest = NULL;
 
+    free(dummy_inst->succ);
+    dummy_inst->succ = NULL;
+
+    free_edgeset(dummy_inst->edges);
+    dummy_inst->edges = NULL;
+
+    free_cutsdata(dummy_inst->cbdata);
+    dummy_inst->cbdata = NULL;
+
+    free_tourpool(dummy_inst->elite);
+    dummy_inst->elite = NULL;
+
     dummy_inst->zstar = CPX_INFBOUND;
 
     dummy_inst->zbest = CPX_INFBOUND;
@@ -182,10 +194,11 @@ void test(instance *user_inst){
         {
             // print first line for performance profile
             bool lazy[] = {false, true};
-            enum formulation_t formulations[] = {GG, MTZ};
-            fprintf(times, "4,");
+            enum formulation_t formulations[] = {GG, MTZ, GGL, MTZL};
+            int nform = sizeof(formulations) / sizeof(formulations[0]);
+            fprintf(times, "%d,", 2 * nform);
             for (int l = 0; l < 2; l++)
-                for (int f = 0; f < 2; f++) {
+                for (int f = 0; f < nform; f++) {
                     fprintf(times, "%s%s,", formulation_names[formulations[f]], lazy[l] ? "-lazy" : "");
                 }
             fprintf(times, "\n");
@@ -197,7 +210,7 @@ void test(instance *user_inst){
                 fprintf(times, "%s,", dummy_inst.name[0]);
 
                 for (int l = 0; l < 2; l++)
-                    for (int f = 0; f < 2; f++) {
+                    for (int f = 0; f < nform; f++) {
                         print(user_inst, 'I', 1, "Executing %s%s...", formulation_names[formulations[f]],
                               lazy[l] ? " lazy" : "");
                         dummy_inst.lazy = lazy[l];
@@ -218,10 +231,8 @@ void test(instance *user_inst){
             // print first line for performance profile
             enum formulation_t formulations[] = {CUTS1, BENDERS};
             fprintf(times, "2,");
-            for (int l = 0; l < 2; l++)
-                for (int f = 0; f < 2; f++) {
-                    fprintf(times, "%s,", formulation_names[formulations[f]]);
-                }
+            for (int f = 0; f < 2; f++)
+                fprintf(times, "%s,", formulation_names[formulations[f]]);
             fprintf(times, "\n");
 
             for (int i = 0; i < NINSTANCES; i++) {
@@ -247,12 +258,11 @@ void test(instance *user_inst){
         case 3: // math-heuristic
         {
             // print first line for performance profile
-            enum formulation_t formulations[] = {HFIXING1, SFIXING1};
-            fprintf(times, "2,");
-            for (int l = 0; l < 2; l++)
-                for (int f = 0; f < 2; f++) {
-                    fprintf(times, "%s,", formulation_names[formulations[f]]);
-                }
+            enum formulation_t formulations[] = {HFIXING1, SFIXING1, HFIXING6, PROXIMITY, RINS, SPATIALFIX, BACKBONE};
+            int nform = sizeof(formulations) / sizeof(formulations[0]);
+            fprintf(times, "%d,", nform);
+            for (int f = 0; f < nform; f++)
+                fprintf(times, "%s,", formulation_names[formulations[f]]);
             fprintf(times, "\n");
 
             for (int i = 0; i < NINSTANCES; i++) {
@@ -262,7 +272,7 @@ void test(instance *user_inst){
                 print(user_inst, 'I', 1, "Generating instance #%d with %d nodes", i + 1, dummy_inst.nnodes);
                 fprintf(times, "#%d,", i + 1);
 
-                for (int f = 0; f < 2; f++) {
+                for (int f = 0; f < nform; f++) {
                     print(user_inst, 'I', 1, "Executing %s...", formulation_names[formulations[f]]);
                     dummy_inst.formulation = formulations[f];
                     TSPOpt(&dummy_inst);
@@ -307,7 +317,7 @@ void test(instance *user_inst){
                 heuristic(&dummy_inst);
 
 
-            if(user_inst->formulation < HFIXING1){ // print time
+            if(is_exact(user_inst->formulation)){ // print time
                 print(user_inst, 'I', 1, "runtime = %ld", dummy_inst.runtime);
                 fprintf(times, "%ld, ", dummy_inst.runtime);
             }else{ // print approx
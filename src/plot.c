@@ -3,16 +3,27 @@
 //
 #include "plot.h"
 
+static void plot_edge(instance *inst, FILE *fcom, int i, int j){
+    fprintf(fcom, "set arrow arrowstyle %d from %f,%f to %f,%f\n",
+            inst->directed?1:2, // choose right arrow style
+            inst->xcoord[i], inst->ycoord[i],
+            inst->xcoord[j], inst->ycoord[j]);
+}
+
+static void plot_draw(instance *inst, const double *rxstar, const int *succ);
+
+// draw the tour without building the n^2 x vector
 void plot_succ(instance *inst, int *succ){
-    double *rxstar = succtox(inst, succ, inst->directed);
-    plot(inst, rxstar);
-    free(rxstar);
+    plot_draw(inst, NULL, succ);
 }
 
 void plot(instance *inst, const double *rxstar){
     if(rxstar == NULL)
         printerr(inst, "plot() argument is NULL");
+    plot_draw(inst, rxstar, NULL);
+}
 
+static void plot_draw(instance *inst, const double *rxstar, const int *succ){
     // write points to file
     char *data_template = "%s-gnuplot-data.dat";
     char data_file[BUFLEN];
@@ -57,15 +68,17 @@ void plot(instance *inst, const double *rxstar){
                            inst->name[0], inst->comment[0], image_name);
 
     // defining edges
-    for(int i = 0; i < inst->nnodes; i++) {
-        int s = inst->directed?0:i+1;
-        for (int j = s; j < inst->nnodes; j++) {
-            int idx = inst->directed ? xpos_directed(i, j, inst) : xpos_undirected(i, j, inst);
-            if (rxstar[idx] > 0.5)
-                fprintf(fcom, "set arrow arrowstyle %d from %f,%f to %f,%f\n",
-                        inst->directed?1:2, // choose right arrow style
-                        inst->xcoord[i], inst->ycoord[i],
-                        inst->xcoord[j], inst->ycoord[j]);
+    if(succ != NULL) {
+        for (int i = 0; i < inst->nnodes; i++)
+            plot_edge(inst, fcom, i, succ[i]);
+    }else {
+        for (int i = 0; i < inst->nnodes; i++) {
+            int s = inst->directed ? 0 : i + 1;
+            for (int j = s; j < inst->nnodes; j++) {
+                int idx = inst->directed ? xpos_directed(i, j, inst) : xpos_undirected(i, j, inst);
+                if (rxstar[idx] > 0.5)
+                    plot_edge(inst, fcom, i, j);
+            }
         }
     }
     // define labels and optimal tour
@@ -0,0 +1,134 @@
+//
+// Created by enrico on 14/07/21.
+//
+
+#include <stdlib.h>
+#include <string.h>
+#include <float.h>
+#include <math.h>
+#include "pool.h"
+
+#define POOL_EPS 1e-9
+
+tourpool * new_tourpool(int nnodes, int cap){
+    tourpool *pool = malloc(sizeof(tourpool));
+    pool->nnodes = nnodes;
+    pool->size = 0;
+    pool->cap = cap;
+    pool->succ = malloc(cap * sizeof(int *));
+    for(int k = 0; k < cap; k++)
+        pool->succ[k] = malloc(nnodes * sizeof(int));
+    pool->z = malloc(cap * sizeof(double));
+    return pool;
+}
+
+void free_tourpool(tourpool *pool){
+    if(pool == NULL) return;
+    for(int k = 0; k < pool->cap; k++)
+        free(pool->succ[k]);
+    free(pool->succ);
+    free(pool->z);
+    free(pool);
+}
+
+/**
+ * Cost a tour must beat to enter the pool
+ */
+double pool_threshold(const tourpool *pool){
+    return (pool->size < pool->cap) ? DBL_MAX : pool->z[pool->size - 1];
+}
+
+// same edges, in the same or in the opposite direction
+static bool same_tour(int n, const int *a, const int *b){
+    bool forward = true, backward = true;
+    for(int i = 0; i < n && (forward || backward); i++){
+        forward = forward && (a[i] == b[i]);
+        backward = backward && (a[b[i]] == i);
+    }
+    return forward || backward;
+}
+
+/**
+ * Add a copy of a tour to the pool, dropping the worst one if it's full.
+ *
+ * @param pool elite pool
+ * @param succ tour
+ * @param z tour cost
+ * @return false if the tour is not good enough or it's already in the pool
+ */
+bool pool_add(tourpool *pool, const int *succ, double z){
+    if(z >= pool_threshold(pool)) return false;
+
+    // tours with the same cost are compared edge by edge
+    int pos = pool->size;
+    for(int k = 0; k < pool->size; k++){
+        if(fabs(pool->z[k] - z) <= POOL_EPS * (1 + fabs(z)) && same_tour(pool->nnodes, pool->succ[k], succ))
+            return false;
+        if(pool->z[k] > z && pos == pool->size) pos = k;
+    }
+
+    // shift the worse tours, recycling the last buffer
+    if(pool->size < pool->cap) pool->size++;
+    int *buf = pool->succ[pool->size - 1];
+    for(int k = pool->size - 1; k > pos; k--){
+        pool->succ[k] = pool->succ[k - 1];
+        pool->z[k] = pool->z[k - 1];
+    }
+    pool->succ[pos] = buf;
+    pool->z[pos] = z;
+    memcpy(buf, succ, pool->nnodes * sizeof(int));
+    return true;
+}
+
+sharedtour * new_sharedtour(int nnodes, const int *succ, double z){
+    sharedtour *s = malloc(sizeof(sharedtour));
+    s->nnodes = nnodes;
+    s->succ = malloc(nnodes * sizeof(int));
+    memcpy(s->succ, succ, nnodes * sizeof(int));
+    atomic_init(&s->z, z);
+    atomic_init(&s->version, 0);
+    pthread_mutex_init(&s->mutex, NULL);
+    return s;
+}
+
+void free_sharedtour(sharedtour *s){
+    if(s == NULL) return;
+    pthread_mutex_destroy(&s->mutex);
+    free(s->succ);
+    free(s);
+}
+
+/**
+ * Copy the shared tour.
+ *
+ * @param s shared tour
+ * @param succ returned tour
+ * @param z returned cost
+ * @return version of the copy
+ */
+long shared_get(sharedtour *s, int *succ, double *z){
+    pthread_mutex_lock(&s->mutex);
+    memcpy(succ, s->succ, s->nnodes * sizeof(int));
+    *z = atomic_load(&s->z);
+    long version = atomic_load(&s->version);
+    pthread_mutex_unlock(&s->mutex);
+    return version;
+}
+
+/**
+ * Replace the shared tour if the given one is better.
+ *
+ * @return true if it was replaced
+ */
+bool shared_put(sharedtour *s, const int *succ, double z){
+    bool better = false;
+    pthread_mutex_lock(&s->mutex);
+    if(z < atomic_load(&s->z) - POOL_EPS * (1 + fabs(z))){
+        memcpy(s->succ, succ, s->nnodes * sizeof(int));
+        atomic_store(&s->z, z);
+        atomic_fetch_add(&s->version, 1);
+        better = true;
+    }
+    pthread_mutex_unlock(&s->mutex);
+    return better;
+}
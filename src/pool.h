@@ -0,0 +1,45 @@
+//
+// Created by enrico on 14/07/21.
+//
+
+#ifndef TSP_OP2_POOL_H
+#define TSP_OP2_POOL_H
+
+#include <stdbool.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+// elite pool: the best distinct tours found so far, sorted by increasing cost
+typedef struct{
+    int nnodes;
+    int size, cap;      // tours in the pool and max number of tours
+    int **succ;         // succ[k] = k-th best tour
+    double *z;          // z[k] = cost of succ[k]
+} tourpool;
+
+// best tour shared by concurrent solvers
+typedef struct sharedtour{
+    int nnodes;
+    int *succ;
+    _Atomic double z;       // cost of succ (can be read without the mutex)
+    _Atomic long version;   // incremented at each update
+    pthread_mutex_t mutex;  // protects succ and z
+} sharedtour;
+
+tourpool * new_tourpool(int nnodes, int cap);
+
+void free_tourpool(tourpool *pool);
+
+double pool_threshold(const tourpool *pool);
+
+bool pool_add(tourpool *pool, const int *succ, double z);
+
+sharedtour * new_sharedtour(int nnodes, const int *succ, double z);
+
+void free_sharedtour(sharedtour *s);
+
+long shared_get(sharedtour *s, int *succ, double *z);
+
+bool shared_put(sharedtour *s, const int *succ, double z);
+
+#endif //TSP_OP2_POOL_H
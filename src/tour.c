@@ -0,0 +1,187 @@
+//
+// Created by enrico on 24/06/21.
+//
+
+#include "tour.h"
+#include "distances.h"
+
+tour * new_tour(int nnodes){
+    tour *t = malloc(sizeof(tour));
+    t->nnodes = nnodes;
+    t->node = malloc(nnodes * sizeof(int));
+    t->pos = malloc(nnodes * sizeof(int));
+    t->logging = false;
+    t->log = NULL;
+    t->loglen = t->logcap = 0;
+    return t;
+}
+
+/**
+ * Fill a tour (sequence + position index) from a successors vector
+ * @param inst instance pointer
+ * @param succ successors vector
+ * @param t returned tour starting from node 0 (allocated by caller)
+ */
+void succtotour(instance *inst, const int *succ, tour *t){
+    int curr = 0;
+    for(int p = 0; p < inst->nnodes; p++){
+        if(p > 0 && curr == 0)
+            printerr(inst, "succtotour(): malformed succ[]");
+        t->node[p] = curr;
+        t->pos[curr] = p;
+        curr = succ[curr];
+    }
+    if(curr != 0)
+        printerr(inst, "succtotour(): malformed succ[]");
+}
+
+void tourtosucc(const tour *t, int *succ){
+    for(int p = 0; p < t->nnodes - 1; p++)
+        succ[t->node[p]] = t->node[p + 1];
+    succ[t->node[t->nnodes - 1]] = t->node[0];
+}
+
+void copy_tour(tour *dst, const tour *src){
+    memcpy(dst->node, src->node, src->nnodes * sizeof(int));
+    memcpy(dst->pos, src->pos, src->nnodes * sizeof(int));
+}
+
+void free_tour(tour *t){
+    if(t == NULL) return;
+    free(t->node);
+    free(t->pos);
+    free(t->log);
+    free(t);
+}
+
+int tour_next(const tour *t, int i){
+    int p = t->pos[i] + 1;
+    return t->node[(p == t->nnodes) ? 0 : p];
+}
+
+int tour_prev(const tour *t, int i){
+    int p = t->pos[i];
+    return t->node[(p == 0) ? t->nnodes - 1 : p - 1];
+}
+
+double cost_tour(instance *inst, const tour *t){
+    double z = 0;
+    for(int p = 0; p < t->nnodes - 1; p++)
+        z += cost(t->node[p], t->node[p + 1], inst);
+    return z + cost(t->node[t->nnodes - 1], t->node[0], inst);
+}
+
+// ===== undo log =====
+// entries are pushed on a stack of int, the last one being the entry type
+#define LOG_REVERSE 0   // [i, j, LOG_REVERSE]: positions i...j were reversed
+#define LOG_WRITE 1     // [old nodes..., p, len, LOG_WRITE]: positions p...p+len-1 were overwritten
+
+static void log_push(tour *t, int v){
+    if(t->loglen == t->logcap){
+        t->logcap = (t->logcap == 0) ? 1024 : 2 * t->logcap;
+        t->log = realloc(t->log, t->logcap * sizeof(int));
+    }
+    t->log[t->loglen++] = v;
+}
+
+static void reverse(tour *t, int i, int j, int len){
+    int n = t->nnodes;
+    for(int k = 0; k < len / 2; k++){
+        int a = t->node[i], b = t->node[j];
+        t->node[i] = b;
+        t->pos[b] = i;
+        t->node[j] = a;
+        t->pos[a] = j;
+        if(++i == n) i = 0;
+        if(--j < 0) j = n - 1;
+    }
+}
+
+/**
+ * Reverse the path from position i to position j (cyclic).
+ * The shortest side of the tour is reversed, i.e. it costs O(min(len, n - len)):
+ * the cycle is the same but positions and orientation must be read again.
+ *
+ * @param t tour
+ * @param i first position
+ * @param j last position
+ */
+void tour_reverse(tour *t, int i, int j){
+    int n = t->nnodes;
+    int len = j - i + 1;
+    if(len <= 0) len += n;
+    if(2 * len > n){
+        // reverse the complement instead
+        int tmp = i;
+        i = (j + 1 == n) ? 0 : j + 1;
+        j = (tmp == 0) ? n - 1 : tmp - 1;
+        len = n - len;
+    }
+    reverse(t, i, j, len);
+    if(t->logging){
+        log_push(t, i);
+        log_push(t, j);
+        log_push(t, LOG_REVERSE);
+    }
+}
+
+/**
+ * Overwrite len positions starting from p (cyclic)
+ *
+ * @param t tour
+ * @param p first position
+ * @param nodes new nodes (same set of the overwritten ones)
+ * @param len number of positions
+ */
+void tour_write(tour *t, int p, const int *nodes, int len){
+    int n = t->nnodes;
+    for(int q = 0; q < len; q++){
+        int r = (p + q) % n;
+        if(t->logging) log_push(t, t->node[r]);
+        t->node[r] = nodes[q];
+        t->pos[nodes[q]] = r;
+    }
+    if(t->logging){
+        log_push(t, p);
+        log_push(t, len);
+        log_push(t, LOG_WRITE);
+    }
+}
+
+/**
+ * Start recording changes: tour_rollback() restores the tour as it is now
+ * in O(changes) time, tour_commit() accepts them.
+ */
+void tour_mark(tour *t){
+    t->loglen = 0;
+    t->logging = true;
+}
+
+void tour_commit(tour *t){
+    t->loglen = 0;
+    t->logging = false;
+}
+
+void tour_rollback(tour *t){
+    int n = t->nnodes;
+    while(t->loglen > 0){
+        int type = t->log[--t->loglen];
+        if(type == LOG_REVERSE){
+            int j = t->log[--t->loglen];
+            int i = t->log[--t->loglen];
+            int len = j - i + 1;
+            if(len <= 0) len += n;
+            reverse(t, i, j, len);
+        }else{ // LOG_WRITE
+            int len = t->log[--t->loglen];
+            int p = t->log[--t->loglen];
+            for(int q = len - 1; q >= 0; q--){
+                int r = (p + q) % n;
+                int v = t->log[--t->loglen];
+                t->node[r] = v;
+                t->pos[v] = r;
+            }
+        }
+    }
+    t->logging = false;
+}
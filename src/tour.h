@@ -0,0 +1,48 @@
+//
+// Created by enrico on 24/06/21.
+//
+
+#ifndef TSP_OP2_TOUR_H
+#define TSP_OP2_TOUR_H
+
+#include "utils.h"
+
+// a tour as a sequence of nodes plus its position index
+typedef struct{
+    int nnodes;
+    int *node;      // node[p] = node visited at position p
+    int *pos;       // pos[i] = position of node i, i.e. node[pos[i]] = i
+
+    // undo log (see tour_mark())
+    bool logging;
+    int *log;
+    int loglen, logcap;
+} tour;
+
+tour * new_tour(int nnodes);
+
+void succtotour(instance *inst, const int *succ, tour *t);
+
+void tourtosucc(const tour *t, int *succ);
+
+void copy_tour(tour *dst, const tour *src);
+
+void free_tour(tour *t);
+
+int tour_next(const tour *t, int i);
+
+int tour_prev(const tour *t, int i);
+
+double cost_tour(instance *inst, const tour *t);
+
+void tour_reverse(tour *t, int i, int j);
+
+void tour_write(tour *t, int p, const int *nodes, int len);
+
+void tour_mark(tour *t);
+
+void tour_commit(tour *t);
+
+void tour_rollback(tour *t);
+
+#endif //TSP_OP2_TOUR_H
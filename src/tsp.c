@@ -1,5 +1,10 @@
 #include "tsp.h"
 #include "formulation_hfixing.h"
+#include "formulation_proximity.h"
+#include "formulation_rins.h"
+#include "formulation_spatial.h"
+#include "formulation_backbone.h"
+#include "formulation_portfolio.h"
 
 double get_zstar_opt(instance *inst){
     if(inst->opt_tour == NULL){
@@ -53,6 +58,11 @@ void TSPOpt(instance *inst){
     // performance measure
     gettimeofday(&inst->tstart, NULL);
 
+    if(inst->sparse && inst->formulation != CUTS1 && inst->formulation != CUTS2) {
+        print(inst, 'W', 1, "Sparse models are available only for cuts formulations: --sparse ignored");
+        inst->sparse = false;
+    }
+
     // choose formulation
     switch(inst->formulation) {
         // ============== matheuristics ==============
@@ -73,13 +83,42 @@ void TSPOpt(instance *inst){
             build_model_hfixing(inst);
             solve_hfixing(inst);
             break;
+        case HFIXING6:
+            inst->directed = false;
+            build_model_hfixing(inst);
+            solve_hfixing_portfolio(inst);
+            break;
+        case PROXIMITY:
+            inst->directed = false;
+            build_model_proximity(inst);
+            solve_proximity(inst);
+            break;
+        case RINS:
+            inst->directed = false;
+            build_model_hfixing(inst);
+            solve_rins(inst);
+            break;
+        case SPATIALFIX: // no model of the whole graph
+            inst->directed = false;
+            solve_spatialfix(inst);
+            break;
+        case BACKBONE: // solved below
+            inst->directed = false;
+            build_model_backbone(inst);
+            break;
+        case PORTFOLIO: // solved below
+            inst->directed = false;
+            build_model_portfolio(inst);
+            break;
         // ============== exact methods: directed graphs ==============
         case MTZ:
+        case MTZL:
             inst->directed = true;
             build_model_MTZ(inst);
             break;
         case GG:
         case GGi:
+        case GGL:
             inst->directed = true;
             build_model_GG(inst);
             break;
@@ -90,18 +129,35 @@ void TSPOpt(instance *inst){
             build_model_cuts(inst);
             break;
         case BENDERS:
+            inst->directed = false;
+            loop_benders(inst);
+            break;
         default:
             printerr(inst, "Method not implemented!");
     }
 
+    // heuristic warm start of the compact models (the other ones take care of it)
+    if(inst->ws_cons != CHLAST && (inst->formulation == MTZ || inst->formulation == MTZL ||
+                                    inst->formulation == GG || inst->formulation == GGi || inst->formulation == GGL)){
+        warm_start(inst, GREEDY);
+        inst->directed = true;
+        add_mipstarts(inst);
+    }
+
     // save model to file
     if(inst->verbose > 0)
         save_model(inst);
 
     // optimize!
-    if(inst->xstar == NULL) {
+    if(inst->xstar == NULL && inst->formulation != SPATIALFIX) {
         if (inst->verbose >= 1) printf(BOLDGREEN "[INFO] Optimization started! Please wait...\n" RESET);
-        if (CPXmipopt(inst->CPXenv, inst->CPXlp))
+        if(inst->formulation == BACKBONE)
+            solve_backbone(inst);
+        else if(inst->formulation == PORTFOLIO)
+            solve_portfolio(inst);
+        else if(inst->edges != NULL)
+            solve_sparse(inst);
+        else if (CPXmipopt(inst->CPXenv, inst->CPXlp))
             printerr(inst, "CPXmipopt() error!");
     }
 
@@ -165,21 +221,32 @@ void TSPOpt(instance *inst){
         case HFIXING3:
         case HFIXING4:
         case HFIXING5:
+        case HFIXING6:
+        case PROXIMITY:
+        case RINS:
             get_solution_hfixing(inst);
             break;
+        case SPATIALFIX: // tour in inst->succ
+            break;
         // ============== directed graphs ==============
         case MTZ:
+        case MTZL:
             get_solution_MTZ(inst);
             break;
         case GG:
         case GGi:
+        case GGL:
             get_solution_GG(inst);
             break;
         // ============== undirected graphs ==============
         case CUTS1:
         case CUTS2:
+        case BACKBONE:
             get_solution_cuts(inst);
             break;
+        case PORTFOLIO:
+            get_solution_portfolio(inst);
+            break;
         case BENDERS:
         default:
             get_solution_Benders(inst);
@@ -200,6 +267,8 @@ void TSPOpt(instance *inst){
             plot(inst, inst->xstar);
         else if(inst->xbest != NULL)
             plot(inst, inst->xbest);
+        else if(inst->succ != NULL)
+            plot_succ(inst, inst->succ);
     }
 }
 
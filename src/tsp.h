@@ -11,11 +11,15 @@
 // formulations
 #include "formulation_Benders.h"
 #include "formulation_cuts.h"
+#include "formulation_pricing.h"
 #include "formulation_MTZ.h"
 #include "formulation_GG.h"
 
 #include "formulation_sfixing.h"
 
+// warm start
+#include "heuristics.h"
+
 void TSPOpt(instance *inst);
 
 void save_model(instance *inst);
@@ -0,0 +1,63 @@
+//
+// Created by enrico on 29/06/21.
+//
+
+#include <stdlib.h>
+#include "unionfind.h"
+
+unionfind * new_unionfind(int n){
+    unionfind *uf = malloc(sizeof(unionfind));
+    uf->n = n;
+    uf->parent = malloc(n * sizeof(int));
+    uf->rank = malloc(n * sizeof(int));
+    uf_reset(uf);
+    return uf;
+}
+
+void free_unionfind(unionfind *uf){
+    if(uf == NULL) return;
+    free(uf->parent);
+    free(uf->rank);
+    free(uf);
+}
+
+// every element in its own set
+void uf_reset(unionfind *uf){
+    for(int i = 0; i < uf->n; i++){
+        uf->parent[i] = i;
+        uf->rank[i] = 0;
+    }
+    uf->nsets = uf->n;
+}
+
+int uf_find(unionfind *uf, int i){
+    int root = i;
+    while(uf->parent[root] != root) root = uf->parent[root];
+
+    // path compression
+    while(uf->parent[i] != root){
+        int next = uf->parent[i];
+        uf->parent[i] = root;
+        i = next;
+    }
+    return root;
+}
+
+/**
+ * Merge the sets of i and j
+ * @return false if they were already in the same set
+ */
+bool uf_union(unionfind *uf, int i, int j){
+    int ri = uf_find(uf, i), rj = uf_find(uf, j);
+    if(ri == rj) return false;
+
+    if(uf->rank[ri] < uf->rank[rj]){
+        int t = ri;
+        ri = rj;
+        rj = t;
+    }
+    uf->parent[rj] = ri;
+    if(uf->rank[ri] == uf->rank[rj]) uf->rank[ri]++;
+    uf->nsets--;
+    return true;
+}
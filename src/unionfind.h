@@ -0,0 +1,28 @@
+//
+// Created by enrico on 29/06/21.
+//
+
+#ifndef TSP_OP2_UNIONFIND_H
+#define TSP_OP2_UNIONFIND_H
+
+#include <stdbool.h>
+
+// disjoint sets with union by rank and path compression
+typedef struct{
+    int n;
+    int *parent;
+    int *rank;
+    int nsets;      // number of disjoint sets
+} unionfind;
+
+unionfind * new_unionfind(int n);
+
+void free_unionfind(unionfind *uf);
+
+void uf_reset(unionfind *uf);
+
+int uf_find(unionfind *uf, int i);
+
+bool uf_union(unionfind *uf, int i, int j);
+
+#endif //TSP_OP2_UNIONFIND_H
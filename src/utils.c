@@ -10,16 +10,21 @@
 
 #include "utils.h"
 #include "formulation_commons.h"
+#include "formulation_cuts.h"
 
-const char *formulation_names[] = {"cuts1", "cuts2", "Benders", "MTZ", "GG", "GGi",
-                                   "hard-fixing1", "hard-fixing2", "hard-fixing3", "hard-fixing4", "hard-fixing5",
-                                   "soft-fixing1", "soft-fixing2", "soft-fixing3", "soft-fixing4",
+const char *formulation_names[] = {"cuts1", "cuts2", "Benders", "MTZ", "MTZL", "GG", "GGi", "GGL",
+                                   "hard-fixing1", "hard-fixing2", "hard-fixing3", "hard-fixing4", "hard-fixing5", "hard-fixing6",
+                                   "soft-fixing1", "soft-fixing2", "soft-fixing3", "soft-fixing4", "proximity", "rins", "spatial-fixing", "backbone", "portfolio",
                                    "none"};
 
-const char *cons_heuristic_names[] = {"greedy", "greedy-grasp", "extra-mileage", "extra-mileage-convex-hull", "none"};
+const char *cons_heuristic_names[] = {"greedy", "greedy-grasp", "extra-mileage", "extra-mileage-convex-hull",
+                                      "greedy-edge", "space-filling-curve", "double-tree", "christofides",
+                                      "savings", "none"};
 
 const char *ref_heuristic_names[] = {"two-opt", "two-opt-min", "vns1", "vns2", "tabu-search1", "tabu-search2", "tabu-search3", "none"};
 
+const char *insertion_names[] = {"cheapest", "nearest", "farthest", "random", "none"};
+
 void init_instance(instance *inst){
     // ===== from cli =====
     inst->input_tsp_file_name = NULL;
@@ -27,7 +32,12 @@ void init_instance(instance *inst){
     inst->formulation = FLAST;
     inst->cons_heuristic = CHLAST;
     inst->ref_heuristic = RHLAST;
+    inst->insertion = CHEAPEST;
     inst->lazy = false;
+    inst->sparse = false;
+    inst->ws_cons = CHLAST;
+    inst->ws_nref = 0;
+    inst->ws_time = 0;
     inst->seed = DEFAULT_CPLEX_SEED;
     inst->integer_costs = true;
     inst->time_limit = CPX_INFBOUND;
@@ -55,20 +65,43 @@ void init_instance(instance *inst){
     inst->CPXlp = NULL;
     inst->ncols = -1;
     inst->nrows = -1;
+    inst->edges = NULL;
+    inst->cbdata = NULL;
 
     // ===== other parameters =====
     inst->directed = false;
     inst->tstart.tv_sec = inst->tstart.tv_usec = 0;
+    inst->cand = NULL;
+    inst->ncand = 0;
 
     // ===== results =====
     inst->runtime = -1;
     inst->xstar = NULL;
     inst->zstar = CPX_INFBOUND;
     inst->xbest = NULL;
+    inst->elite = NULL;
     inst->zbest = CPX_INFBOUND;
     inst->status = -1; // to be set to >0 by CPLEX
     inst->succ = NULL;
 }
+// true iff the formulation proves optimality (its runtime is measured, not its zbest)
+bool is_exact(enum formulation_t f){
+    switch(f){
+        case CUTS1:
+        case CUTS2:
+        case BENDERS:
+        case MTZ:
+        case MTZL:
+        case GG:
+        case GGi:
+        case GGL:
+        case PORTFOLIO:
+            return true;
+        default:
+            return false;
+    }
+}
+
 void free_instance(instance *inst){
     free(inst->input_tsp_file_name);
     free(inst->input_opt_file_name);
@@ -91,6 +124,20 @@ void free_instance(instance *inst){
 
     free(inst->succ);
 
+    // candidates depend on the points: don't keep them for the next instance
+    free(inst->cand);
+    inst->cand = NULL;
+    inst->ncand = 0;
+
+    free_edgeset(inst->edges);
+    inst->edges = NULL;
+
+    free_cutsdata(inst->cbdata);
+    inst->cbdata = NULL;
+
+    free_tourpool(inst->elite);
+    inst->elite = NULL;
+
     CPXfreeprob(inst->CPXenv, &inst->CPXlp);
     CPXcloseCPLEX(&inst->CPXenv);
 }
@@ -163,6 +210,22 @@ int nrand(){
     return rand() % 100 + 1;
 }
 
+// thread-safe nrand() on a private RNG state
+int nrand_r(unsigned int *seed){
+    return rand_r(seed) % 100 + 1;
+}
+
+// rand(), or rand_r() on a private RNG state if seed isn't NULL
+int rand_s(unsigned int *seed){
+    return (seed != NULL) ? rand_r(seed) : rand();
+}
+
+// number of online processors (at least 1)
+int ncores(){
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return (n < 1) ? 1 : (int) n;
+}
+
 void start(instance *inst){
     gettimeofday(&inst->tstart, NULL);
 }
@@ -11,6 +11,12 @@
 #include <stdbool.h>
 
 #include <cplex.h>
+
+#include "edgeset.h"
+#include "pool.h"
+
+struct cutsdata;
+
 // ANSI escape sequences
 #define RESET       "\033[0m"
 #define BOLDRED     "\033[1m\033[31m"
@@ -22,14 +28,18 @@
 // NB it changes with each CPLEX release!
 #define DEFAULT_CPLEX_SEED 202009243 // from cplex (display settings all)
 
-enum formulation_t {CUTS1, CUTS2, BENDERS, MTZ, GG, GGi, HFIXING1, HFIXING2, HFIXING3, HFIXING4, HFIXING5, SFIXING1, SFIXING2, SFIXING3, SFIXING4, FLAST}; // FLAST is enum guard
-enum cons_heuristic_t {GREEDY, GREEDYGRASP, EXTRAMILEAGE, EXTRAMILEAGECONVEXHULL, CHLAST}; // CHLAST is enum guard
+#define WS_MAXCHAIN 4 // max number of refinement heuristics in the warm-start chain
+
+enum formulation_t {CUTS1, CUTS2, BENDERS, MTZ, MTZL, GG, GGi, GGL, HFIXING1, HFIXING2, HFIXING3, HFIXING4, HFIXING5, HFIXING6, SFIXING1, SFIXING2, SFIXING3, SFIXING4, PROXIMITY, RINS, SPATIALFIX, BACKBONE, PORTFOLIO, FLAST}; // FLAST is enum guard
+enum cons_heuristic_t {GREEDY, GREEDYGRASP, EXTRAMILEAGE, EXTRAMILEAGECONVEXHULL, GREEDYEDGE, SPACEFILLINGCURVE, DOUBLETREE, CHRISTOFIDES, SAVINGS, CHLAST}; // CHLAST is enum guard
 enum ref_heuristic_t {TWO_OPT, TWO_OPT_MIN, VNS1, VNS2, TABU_SEARCH1, TABU_SEARCH2, TABU_SEARCH3, RHLAST};
+enum insertion_t {CHEAPEST, NEAREST, FARTHEST, RANDOM, ILAST}; // ILAST is enum guard
 enum distance_t {EUC_2D, ATT, GEO};
 
-const char *formulation_names[16];
-const char *cons_heuristic_names[5];
+const char *formulation_names[24];
+const char *cons_heuristic_names[10];
 const char *ref_heuristic_names[8];
+const char *insertion_names[5];
 
 // define a general instance of the problem
 typedef struct{
@@ -39,7 +49,13 @@ typedef struct{
     enum formulation_t formulation;         // formulation type
     enum cons_heuristic_t cons_heuristic;   // cons_heuristic type
     enum ref_heuristic_t ref_heuristic;
+    enum insertion_t insertion;             // insertion policy of extra-mileage
     bool lazy;                              // add formulation-specific constraints in lazy way
+    bool sparse;                            // start undirected models from a sparse edge set
+    enum cons_heuristic_t ws_cons;          // warm-start constructive heuristic (CHLAST for the default one)
+    enum ref_heuristic_t ws_ref[WS_MAXCHAIN]; // warm-start refinement heuristics, applied in order
+    int ws_nref;                            // length of ws_ref
+    double ws_time;                         // warm-start time budget (0 for the default one)
     int seed;                               // cplex random seed
     bool integer_costs;             // force to use integer cost (only for EUC_2D)
     double time_limit;              // overall time limit - CPLEX parameter
@@ -67,10 +83,14 @@ typedef struct{
     CPXLPptr CPXlp;                 // CPLEX linear problem
     int ncols;                      // number of columns in the tableau
     int nrows;                      // number of rows in the tableau
+    edgeset *edges;                 // x columns of sparse models (NULL for the dense ones)
+    struct cutsdata *cbdata;        // callback data of cuts formulations
 
     // ===== other parameters =====
     bool directed;                  // use directed graph (for plot purpose)
     struct timeval tstart;
+    int *cand;                      // candidate lists: cand[i * ncand + k] is the (k+1)-th nearest node to i
+    int ncand;                      // candidate list length
 
     // ===== results =====
     long runtime;                   // overall runtime
@@ -78,12 +98,15 @@ typedef struct{
     double zstar;                   // optimal solution value
     double zbest;                   // best solution value found for euristics
     double *xbest;                  // best solution found for euristics
+    tourpool *elite;                // best distinct tours found by the warm start
     int status;                     // cplex status
     int *succ;                      // array of successor (i,j) => succ[i] = j
 } instance;
 
 void init_instance(instance *inst);
 
+bool is_exact(enum formulation_t f);
+
 void free_instance(instance *inst);
 
 void save_instance_to_tsp_file(instance *inst);
@@ -96,6 +119,12 @@ bool uprob(double perc);
 
 int nrand();
 
+int nrand_r(unsigned int *seed);
+
+int rand_s(unsigned int *seed);
+
+int ncores();
+
 void start(instance *inst);
 
 bool timeout(instance *inst);